@@ -6,7 +6,8 @@
 //          This server implements the standard two-copy data path using
 //          send() / recv().  It accepts multiple concurrent clients, spawns
 //          one pthread per client, and continuously sends a heap-allocated
-//          message_t (8 string fields) until the client disconnects.
+//          message_t (8 string fields by default, see --nfields /
+//          --profile) until the client disconnects.
 //
 // Two-Copy Data Path (send):
 // ==========================
@@ -28,295 +29,315 @@
 //           DMA controller to read the data from kernel memory into the
 //           hardware transmit ring.
 //
+// Segment coalescing (--coalesce):
+// =================================
+//   With TCP_NODELAY set, each of the per-field send() calls may leave
+//   the host as its own small segment.  --coalesce keeps one syscall per
+//   field but tells the kernel more data follows, so it fills segments
+//   the way A2's single sendmsg() does:
+//     more – every field but the last is sent with MSG_MORE; the last
+//            without it, which pushes out whatever is still queued.
+//     cork – TCP_CORK is set before the first field and cleared after
+//            the last.
+//            Costs two extra setsockopt() calls per message.
+//   The close report gives syscalls per message and the number of TCP
+//   data segments (TCP_INFO) to compare against plain A1 and A2.
+//
 // Usage:
-//   ./MT25082_Part_A1_Server <port> <message_size_bytes>
+//   ./MT25082_Part_A1_Server [--mode thread|epoll] [--coalesce more|cork]
+//                            <port> <message_size_bytes>
 //
 // Example:
 //   ./MT25082_Part_A1_Server 9090 4096
+//   ./MT25082_Part_A1_Server --mode epoll 9090 4096
+//   ./MT25082_Part_A1_Server --coalesce cork 9090 64
 // =============================================================================
 
-#include "MT25082_common.h"
+#include "MT25082_server.h"
 
 // ---------------------------------------------------------------------------
-//  Global flag for clean SIGINT shutdown.
-//  Declared volatile so every thread sees updates immediately.
-//  This is the ONLY global; no shared buffers exist.
+//  Server-specific options
 // ---------------------------------------------------------------------------
-static volatile sig_atomic_t g_running = 1;
+typedef enum {
+    COALESCE_NONE = 0,          /* One plain send() per field                */
+    COALESCE_MORE,              /* MSG_MORE on all but the last field        */
+    COALESCE_CORK               /* TCP_CORK around each message              */
+} coalesce_t;
+
+static coalesce_t g_coalesce = COALESCE_NONE;
+
+static const struct option a1_long_opts[] = {
+    { "coalesce", required_argument, NULL, 'C' },
+    { NULL,       0,                 NULL,  0  }
+};
 
+static int a1_parse_opt(int c, const char *arg)
+{
+    switch (c) {
+    case 'C':
+        if (strcmp(arg, "more") == 0) {
+            g_coalesce = COALESCE_MORE;
+        } else if (strcmp(arg, "cork") == 0) {
+            g_coalesce = COALESCE_CORK;
+        } else if (strcmp(arg, "none") == 0) {
+            g_coalesce = COALESCE_NONE;
+        } else {
+            fprintf(stderr, "[Server] Unknown coalesce mode '%s' "
+                    "(expected more|cork|none)\n", arg);
+            return -1;
+        }
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+// ===========================================================================
+//  a1_conn_t
+// ===========================================================================
+//  Per-connection send state.  A message is n fields sent one by one, so
+//  the state machine remembers which field is in progress and how many of
+//  its bytes have already been accepted by the kernel.  This lets a
+//  non-blocking socket resume exactly where a short send() stopped.
+//  Empty fields of a --profile layout are skipped: send() of 0 bytes
+//  would return 0, which reads as a closed connection.
 // ---------------------------------------------------------------------------
-//  SIGINT handler — sets the flag so accept() / send() loops exit cleanly.
+typedef struct {
+    int       fd;                       /* Connected socket                  */
+    bool      nonblocking;              /* true in epoll mode                */
+    size_t    msg_size;                 /* Total message size (bytes)        */
+    message_t msg;                      /* Private heap-allocated message    */
+    const msg_layout_t *layout;         /* Field count and sizes             */
+    int       first_field;              /* First non-empty field             */
+    int       last_field;               /* Last non-empty field              */
+    int       cur_field;                /* Field currently being sent        */
+    size_t    field_off;                /* Bytes of cur_field already sent   */
+    bool      corked;                   /* TCP_CORK currently set            */
+    size_t    total_bytes_sent;
+    size_t    total_messages;
+    size_t    syscalls;                 /* send() + setsockopt() calls       */
+    double    start_time;
+} a1_conn_t;
+
 // ---------------------------------------------------------------------------
-static void sigint_handler(int signo)
+//  a1_set_cork
+// ---------------------------------------------------------------------------
+static int a1_set_cork(a1_conn_t *c, int on)
 {
-    (void)signo;        /* Unused parameter */
-    g_running = 0;
+    c->syscalls++;
+    if (setsockopt(c->fd, IPPROTO_TCP, TCP_CORK, &on, sizeof(on)) < 0) {
+        perror("[Server] setsockopt TCP_CORK");
+        return -1;
+    }
+    c->corked = (on != 0);
+    return 0;
 }
 
 // ===========================================================================
-//  client_handler
+//  a1_open
 // ===========================================================================
-//  Thread entry point.  Each connected client gets its own thread running
-//  this function.  The thread:
+//  Allocates the per-connection state.  Each connection:
 //    1. Allocates its own message_t on the heap  (no shared buffers).
 //    2. Fills the message with deterministic data.
-//    3. Sends the 8 fields one by one using send() in a loop.
-//    4. Stops when the client disconnects or the server is shutting down.
-//    5. Frees all heap memory and closes the socket.
 // ---------------------------------------------------------------------------
-static void *client_handler(void *arg)
+static void *a1_open(int fd, const server_opts_t *opts, bool nonblocking)
 {
-    /* ---- Unpack per-thread arguments ---------------------------------- */
-    thread_args_t *targs = (thread_args_t *)arg;
-    int    client_fd = targs->sock_fd;
-    size_t msg_size  = targs->msg_size;
-    free(targs);   /* Heap-allocated by the accept loop; no longer needed */
+    a1_conn_t *c = (a1_conn_t *)calloc(1, sizeof(a1_conn_t));
+    if (c == NULL) {
+        perror("[Server] malloc conn");
+        return NULL;
+    }
+
+    c->fd          = fd;
+    c->nonblocking = nonblocking;
+    c->msg_size    = opts->msg_size;
+    c->layout      = &opts->layout;
 
     printf("[Server] Thread %lu: handling client fd=%d, msg_size=%zu\n",
-           (unsigned long)pthread_self(), client_fd, msg_size);
+           (unsigned long)pthread_self(), fd, c->msg_size);
 
-    /* ---- Allocate message on the heap (per-thread, no sharing) -------- */
+    /* ---- Allocate message on the heap (per-connection, no sharing) ---- */
     /*
      * Heap allocation ensures:
      *   • Sizes determined at runtime are supported.
-     *   • Each thread has private buffers — thread-safe without locks.
+     *   • Each connection has private buffers — thread-safe without locks.
      *   • Faithfully represents the user-space buffer that will be
      *     copied into kernel space (Copy 1) during send().
+     * --alloc only changes where the fields live: even in one block,
+     * every field still goes out with its own send().
      */
-    message_t msg;
-    allocate_message(&msg, msg_size);
-    fill_message(&msg, msg_size);
-
-    /* Pre-compute per-field sizes (mirrors allocate_message logic) */
-    size_t per_field = msg_size / NUM_FIELDS;
-    size_t remainder = msg_size % NUM_FIELDS;
-
-    /* ---- Counters for optional throughput reporting -------------------- */
-    size_t total_bytes_sent = 0;
-    size_t total_messages   = 0;
-    double start_time       = get_time_us();
-
-    /* ---- Main send loop ----------------------------------------------- */
-    while (g_running) {
-        int send_failed = 0;
+    allocate_message_as(&c->msg, c->layout, opts->alloc);
+    fill_message(&c->msg, c->layout);
+    if (c->msg.field == NULL) {
+        free(c);
+        return NULL;
+    }
 
-        for (int i = 0; i < NUM_FIELDS; i++) {
-            size_t field_size = per_field +
-                                ((i == NUM_FIELDS - 1) ? remainder : 0);
+    c->first_field = 0;
+    while (c->layout->size[c->first_field] == 0) {
+        c->first_field++;
+    }
+    c->last_field = c->layout->n_fields - 1;
+    while (c->layout->size[c->last_field] == 0) {
+        c->last_field--;
+    }
+    c->cur_field = c->first_field;
 
-            size_t bytes_sent = 0;
+    c->start_time = get_time_us();
+    return c;
+}
 
-            /* Send the complete field, handling partial sends */
-            while (bytes_sent < field_size) {
-                /*
-                 * =========================================================
-                 *  COPY 1 OCCURS HERE — inside send()
-                 * =========================================================
-                 *  The kernel copies data from the user-space heap buffer
-                 *  (msg.field[i] + bytes_sent) into a kernel-managed
-                 *  sk_buff in the socket's send buffer.
-                 *
-                 *  After this call returns, the application buffer is free
-                 *  to be modified — the kernel holds its own copy.
-                 *
-                 *  COPY 2 happens asynchronously when the NIC driver's
-                 *  DMA engine transfers the sk_buff contents from kernel
-                 *  memory into the NIC's hardware TX ring buffer.
-                 * =========================================================
-                 */
-                ssize_t ret = send(client_fd,
-                                   msg.field[i] + bytes_sent,
-                                   field_size   - bytes_sent,
-                                   MSG_NOSIGNAL);
+// ===========================================================================
+//  a1_step
+// ===========================================================================
+//  Issues ONE send() for the remainder of the current field.  When the
+//  field completes, advances to the next non-empty one; after the last
+//  field the message is counted and the state wraps back to the first.
+//  In cork mode the cork is set before the first field of a message and
+//  released after its last.
+// ---------------------------------------------------------------------------
+static conn_status_t a1_step(void *arg)
+{
+    a1_conn_t *c = (a1_conn_t *)arg;
+    int i = c->cur_field;
+    int flags = MSG_NOSIGNAL;
 
-                if (ret <= 0) {
-                    if (ret == 0) {
-                        /* Client closed the connection gracefully */
-                        printf("[Server] Thread %lu: client disconnected\n",
-                               (unsigned long)pthread_self());
-                    } else {
-                        /* send() error — check if it's a fatal condition */
-                        if (errno == EPIPE || errno == ECONNRESET) {
-                            printf("[Server] Thread %lu: client gone (%s)\n",
-                                   (unsigned long)pthread_self(),
-                                   strerror(errno));
-                        } else if (errno == EINTR) {
-                            continue;   /* Interrupted by signal, retry */
-                        } else {
-                            perror("[Server] send");
-                        }
-                    }
-                    send_failed = 1;
-                    break;
-                }
+    if (g_coalesce == COALESCE_CORK && !c->corked &&
+        a1_set_cork(c, 1) < 0) {
+        return CONN_CLOSED;
+    }
+    if (g_coalesce == COALESCE_MORE && i < c->last_field) {
+        flags |= MSG_MORE;
+    }
 
-                bytes_sent += (size_t)ret;
-            }
+    /*
+     * =====================================================================
+     *  COPY 1 OCCURS HERE — inside send()
+     * =====================================================================
+     *  The kernel copies data from the user-space heap buffer
+     *  (msg.field[i] + field_off) into a kernel-managed sk_buff in the
+     *  socket's send buffer.
+     *
+     *  After this call returns, the application buffer is free to be
+     *  modified — the kernel holds its own copy.
+     *
+     *  COPY 2 happens asynchronously when the NIC driver's DMA engine
+     *  transfers the sk_buff contents from kernel memory into the NIC's
+     *  hardware TX ring buffer.
+     * =====================================================================
+     */
+    ssize_t ret = send(c->fd,
+                       c->msg.field[i]  + c->field_off,
+                       c->layout->size[i] - c->field_off,
+                       flags);
+    c->syscalls++;
+
+    if (ret <= 0) {
+        if (ret == 0) {
+            /* Client closed the connection gracefully */
+            printf("[Server] Thread %lu: client disconnected\n",
+                   (unsigned long)pthread_self());
+            return CONN_CLOSED;
+        }
+        if (errno == EINTR) {
+            return CONN_PROGRESS;   /* Interrupted by signal, retry */
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return CONN_BLOCKED;    /* Send buffer full (epoll mode) */
+        }
+        if (errno == EPIPE || errno == ECONNRESET) {
+            printf("[Server] Thread %lu: client gone (%s)\n",
+                   (unsigned long)pthread_self(), strerror(errno));
+        } else {
+            perror("[Server] send");
+        }
+        return CONN_CLOSED;
+    }
 
-            if (send_failed) {
-                break;
+    c->total_bytes_sent += (size_t)ret;
+    c->field_off        += (size_t)ret;
+
+    /* Field complete — move on; message complete — count it */
+    if (c->field_off == c->layout->size[i]) {
+        c->field_off = 0;
+        if (i == c->last_field) {
+            c->cur_field = c->first_field;
+            c->total_messages++;
+            if (c->corked && a1_set_cork(c, 0) < 0) {
+                return CONN_CLOSED;
             }
+        } else {
+            do {
+                c->cur_field++;
+            } while (c->layout->size[c->cur_field] == 0);
         }
+    }
 
-        if (send_failed) {
-            break;  /* Exit the outer while-loop */
-        }
+    return CONN_PROGRESS;
+}
 
-        total_bytes_sent += msg_size;
-        total_messages++;
-    }
+// ===========================================================================
+//  a1_close
+// ===========================================================================
+//  Reports per-connection statistics, frees all heap memory and closes
+//  the socket.
+// ---------------------------------------------------------------------------
+static void a1_close(void *arg)
+{
+    a1_conn_t *c = (a1_conn_t *)arg;
 
-    /* ---- Report per-thread statistics --------------------------------- */
-    double elapsed_us = get_time_us() - start_time;
+    /* ---- Report per-connection statistics ----------------------------- */
+    double elapsed_us = get_time_us() - c->start_time;
     double elapsed_s  = elapsed_us / 1e6;
     double throughput_gbps = (elapsed_s > 0.0)
-        ? ((double)total_bytes_sent * 8.0) / (elapsed_s * 1e9)
+        ? ((double)c->total_bytes_sent * 8.0) / (elapsed_s * 1e9)
         : 0.0;
 
     printf("[Server] Thread %lu: sent %zu messages (%zu bytes) in %.2f s "
            "— %.4f Gbps\n",
            (unsigned long)pthread_self(),
-           total_messages, total_bytes_sent, elapsed_s, throughput_gbps);
+           c->total_messages, c->total_bytes_sent, elapsed_s, throughput_gbps);
 
-    /* ---- Cleanup: free heap buffers, close socket --------------------- */
-    free_message(&msg);
-    close(client_fd);
+    size_t segs = 0;
+    bool have_segs = (get_tcp_data_segs_out(c->fd, &segs) == 0 && segs > 0);
+    printf("[Server] Thread %lu: %.2f syscalls/msg",
+           (unsigned long)pthread_self(),
+           (c->total_messages > 0)
+               ? (double)c->syscalls / (double)c->total_messages
+               : 0.0);
+    if (have_segs) {
+        printf(", %zu TCP data segments, %.0f bytes/segment",
+               segs, (double)c->total_bytes_sent / (double)segs);
+    }
+    printf("\n");
 
-    return NULL;
+    /* ---- Cleanup: free heap buffers, close socket --------------------- */
+    free_message(&c->msg);
+    close(c->fd);
+    free(c);
 }
 
+static const conn_ops_t a1_ops = {
+    .tag         = "[Server]",
+    .banner      = "Two-Copy Baseline (send/recv)",
+    .open        = a1_open,
+    .step        = a1_step,
+    .on_error    = NULL,
+    .close       = a1_close,
+    .extra_opts  = a1_long_opts,
+    .extra_short = "C:",
+    .extra_usage = "  -C, --coalesce more|cork  let the kernel fill segments "
+                   "across fields:\n"
+                   "                            MSG_MORE on all but the last "
+                   "field, or\n"
+                   "                            TCP_CORK per message\n",
+    .parse_opt   = a1_parse_opt,
+};
+
 // ===========================================================================
 //  main
 // ===========================================================================
 int main(int argc, char *argv[])
 {
-    /* ---- Parse command-line arguments --------------------------------- */
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <port> <message_size_bytes>\n", argv[0]);
-        return EXIT_FAILURE;
-    }
-
-    int    port     = atoi(argv[1]);
-    size_t msg_size = (size_t)atol(argv[2]);
-
-    if (port <= 0 || port > 65535) {
-        fprintf(stderr, "[Server] Invalid port: %d\n", port);
-        return EXIT_FAILURE;
-    }
-    if (msg_size == 0) {
-        fprintf(stderr, "[Server] Message size must be > 0\n");
-        return EXIT_FAILURE;
-    }
-
-    printf("[Server] Two-Copy Baseline (send/recv)\n");
-    printf("[Server] Port: %d | Message size: %zu bytes\n", port, msg_size);
-
-    /* ---- Install SIGINT handler for graceful shutdown ------------------ */
-    struct sigaction sa;
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = sigint_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    if (sigaction(SIGINT, &sa, NULL) < 0) {
-        perror("[Server] sigaction");
-        return EXIT_FAILURE;
-    }
-
-    /* Ignore SIGPIPE so broken-pipe errors are returned via errno */
-    signal(SIGPIPE, SIG_IGN);
-
-    /* ---- Create listening TCP socket ---------------------------------- */
-    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (listen_fd < 0) {
-        perror("[Server] socket");
-        return EXIT_FAILURE;
-    }
-
-    /* Allow immediate port reuse after restart */
-    int opt = 1;
-    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        perror("[Server] setsockopt SO_REUSEADDR");
-        close(listen_fd);
-        return EXIT_FAILURE;
-    }
-
-    /* ---- Bind to the specified port ----------------------------------- */
-    struct sockaddr_in serv_addr;
-    memset(&serv_addr, 0, sizeof(serv_addr));
-    serv_addr.sin_family      = AF_INET;
-    serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    serv_addr.sin_port        = htons((uint16_t)port);
-
-    if (bind(listen_fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
-        perror("[Server] bind");
-        close(listen_fd);
-        return EXIT_FAILURE;
-    }
-
-    /* ---- Start listening ---------------------------------------------- */
-    if (listen(listen_fd, BACKLOG) < 0) {
-        perror("[Server] listen");
-        close(listen_fd);
-        return EXIT_FAILURE;
-    }
-
-    printf("[Server] Listening on port %d … (Ctrl+C to stop)\n", port);
-
-    /* ---- Accept loop: one pthread per client -------------------------- */
-    while (g_running) {
-        struct sockaddr_in client_addr;
-        socklen_t addr_len = sizeof(client_addr);
-
-        int client_fd = accept(listen_fd,
-                               (struct sockaddr *)&client_addr,
-                               &addr_len);
-
-        if (client_fd < 0) {
-            if (errno == EINTR) {
-                /* accept() interrupted by SIGINT — check g_running */
-                continue;
-            }
-            perror("[Server] accept");
-            continue;
-        }
-
-        printf("[Server] Accepted connection from %s:%d (fd=%d)\n",
-               inet_ntoa(client_addr.sin_addr),
-               ntohs(client_addr.sin_port),
-               client_fd);
-
-        /* Disable Nagle's algorithm for lower latency measurements */
-        int flag = 1;
-        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
-
-        /*
-         * Allocate thread_args_t on the heap so it survives past this
-         * loop iteration.  The thread is responsible for freeing it.
-         */
-        thread_args_t *targs = (thread_args_t *)malloc(sizeof(thread_args_t));
-        if (targs == NULL) {
-            perror("[Server] malloc thread_args");
-            close(client_fd);
-            continue;
-        }
-        targs->sock_fd      = client_fd;
-        targs->msg_size     = msg_size;
-        targs->duration_sec = 0;   /* Not used by server; client decides */
-
-        /* Spawn a detached thread — no join needed */
-        pthread_t tid;
-        if (pthread_create(&tid, NULL, client_handler, targs) != 0) {
-            perror("[Server] pthread_create");
-            free(targs);
-            close(client_fd);
-            continue;
-        }
-        pthread_detach(tid);
-    }
-
-    /* ---- Shutdown ----------------------------------------------------- */
-    printf("\n[Server] Shutting down …\n");
-    close(listen_fd);
-
-    return EXIT_SUCCESS;
+    return server_main(argc, argv, &a1_ops);
 }
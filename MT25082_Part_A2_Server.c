@@ -53,56 +53,153 @@
 //
 //   Copy 2 (DMA): Kernel buffer → NIC TX ring via DMA (same as A1).
 //
+// Message batching (--batch K):
+// =============================
+//   One sendmsg() per message costs one system call per 64 bytes at the
+//   smallest size.  With --batch K each step queues one message, and the
+//   queued messages leave together in ONE sendmsg() whose iovec repeats the
+//   field entries per message (at most IOV_MAX entries).  The batch is
+//   flushed as soon as K messages or --batch-bytes B bytes are queued.
+//   Messages are produced back to back, so there is no arrival gap a
+//   time budget could bound: every batch fills immediately.
+//
 // Usage:
-//   ./MT25082_Part_A2_Server <port> <message_size_bytes>
+//   ./MT25082_Part_A2_Server [--mode thread|epoll] [--batch K]
+//                            [--batch-bytes B]
+//                            <port> <message_size_bytes>
 // =============================================================================
 
-#include "MT25082_common.h"
+#define _GNU_SOURCE             /* IOV_MAX                                   */
+
+#include "MT25082_server.h"
+
+#include <limits.h>             /* IOV_MAX                                   */
+
+#define BATCH_HIST      11      /* Histogram buckets: 1, 2-3, ... 1024-2047  */
+
+#if IOV_MAX >= (1 << BATCH_HIST)
+#error "BATCH_HIST too small for IOV_MAX messages per batch"
+#endif
 
 // ---------------------------------------------------------------------------
-//  Global flag for clean SIGINT shutdown.
-//  Declared volatile so every thread sees updates immediately.
+//  Server-specific options
 // ---------------------------------------------------------------------------
-static volatile sig_atomic_t g_running = 1;
+static int    g_batch_msgs     = 1;     /* 1 = one message per sendmsg()     */
+static size_t g_batch_bytes    = 0;     /* 0 = no byte budget                */
+
+static const struct option a2_long_opts[] = {
+    { "batch",       required_argument, NULL, 'b' },
+    { "batch-bytes", required_argument, NULL, 'B' },
+    { NULL,          0,                 NULL,  0  }
+};
+
+static int a2_parse_opt(int c, const char *arg)
+{
+    switch (c) {
+    case 'b':
+        g_batch_msgs = atoi(arg);
+        if (g_batch_msgs < 1) {
+            fprintf(stderr, "[Server-A2] Batch size must be >= 1\n");
+            return -1;
+        }
+        return 0;     /* Upper bound depends on --nfields: see a2_init() */
+    case 'B':
+        g_batch_bytes = (size_t)strtoull(arg, NULL, 10);
+        return 0;
+    default:
+        return -1;
+    }
+}
 
 // ---------------------------------------------------------------------------
-//  SIGINT handler
+//  a2_init — a batch must fit in one iovec of at most IOV_MAX entries.
 // ---------------------------------------------------------------------------
-static void sigint_handler(int signo)
+static int a2_init(const server_opts_t *opts)
 {
-    (void)signo;
-    g_running = 0;
+    int max_msgs = IOV_MAX / opts->layout.n_fields;
+
+    if (g_batch_msgs > max_msgs) {
+        fprintf(stderr, "[Server-A2] Batch size must be 1..%d "
+                "(IOV_MAX / %d fields)\n", max_msgs, opts->layout.n_fields);
+        return -1;
+    }
+    return 0;
 }
 
 // ===========================================================================
-//  client_handler
+//  a2_conn_t
+// ===========================================================================
+//  Per-connection send state.  The iovec and msghdr are pre-registered
+//  once; the cursor records how much of the current message (or batch) a
+//  short sendmsg() already delivered so the next step resumes from there.
+//
+//  In batch mode iov[] holds the message's entries repeated for --batch
+//  messages, so a batch of n messages is simply its first n * n_iov
+//  entries.
+// ---------------------------------------------------------------------------
+typedef struct {
+    int           fd;                   /* Connected socket                  */
+    bool          nonblocking;          /* true in epoll mode                */
+    size_t        msg_size;             /* Total message size (bytes)        */
+    message_t     msg;                  /* Private heap-allocated message    */
+    int           n_iov;                /* iovec entries per message         */
+    struct iovec *iov;                  /* Pre-registered scatter array      */
+    int           iov_cap;              /* Messages iov[] can describe       */
+    struct msghdr mh;                   /* Reused across all sends           */
+    iov_cursor_t  out;                  /* Position in the message / batch   */
+
+    /* Batching */
+    int           batch_n;              /* Messages queued / in flight       */
+    bool          flushing;             /* Batch handed to sendmsg()         */
+    size_t        batch_hist[BATCH_HIST]; /* log2 histogram of batch sizes   */
+    size_t        flush_count;          /* Flushes by reason: K reached      */
+    size_t        flush_bytes;          /*   byte budget reached             */
+
+    size_t        total_bytes_sent;
+    size_t        total_messages;
+    size_t        sendmsg_calls;
+    double        start_time;
+} a2_conn_t;
+
+// ===========================================================================
+//  a2_open
 // ===========================================================================
-//  Thread entry point.  Each client gets its own thread.
+//  Allocates the message and pre-registers its fields as iovec entries.
 //
 //  Key difference from A1:
 //    • Instead of 8 separate send() calls, we pre-register all 8 message
 //      fields as iovec entries and issue a SINGLE sendmsg() call per
 //      message.  This eliminates the redundant per-field copy overhead.
 // ---------------------------------------------------------------------------
-static void *client_handler(void *arg)
+static void *a2_open(int fd, const server_opts_t *opts, bool nonblocking)
 {
-    /* ---- Unpack per-thread arguments ---------------------------------- */
-    thread_args_t *targs = (thread_args_t *)arg;
-    int    client_fd = targs->sock_fd;
-    size_t msg_size  = targs->msg_size;
-    free(targs);   /* Heap-allocated by accept loop; thread owns lifetime */
-
-    printf("[Server-A2] Thread %lu: handling client fd=%d, msg_size=%zu\n",
-           (unsigned long)pthread_self(), client_fd, msg_size);
+    a2_conn_t *c = (a2_conn_t *)calloc(1, sizeof(a2_conn_t));
+    if (c == NULL) {
+        perror("[Server-A2] malloc conn");
+        return NULL;
+    }
 
-    /* ---- Allocate message on the heap (per-thread, no sharing) -------- */
-    message_t msg;
-    allocate_message(&msg, msg_size);
-    fill_message(&msg, msg_size);
+    c->fd          = fd;
+    c->nonblocking = nonblocking;
+    c->msg_size    = opts->msg_size;
 
-    /* Pre-compute per-field sizes */
-    size_t per_field = msg_size / NUM_FIELDS;
-    size_t remainder = msg_size % NUM_FIELDS;
+    printf("[Server-A2] Thread %lu: handling client fd=%d, msg_size=%zu\n",
+           (unsigned long)pthread_self(), fd, c->msg_size);
+
+    /* ---- Allocate message on the heap (per-connection, no sharing) ---- */
+    const msg_layout_t *layout = &opts->layout;
+    allocate_message_as(&c->msg, layout, opts->alloc);
+    fill_message(&c->msg, layout);
+
+    c->iov_cap  = g_batch_msgs;
+    c->iov = (struct iovec *)calloc((size_t)c->iov_cap * layout->n_fields,
+                                    sizeof(struct iovec));
+    if (c->msg.field == NULL || c->iov == NULL) {
+        perror("[Server-A2] malloc iovec");
+        free_message(&c->msg);
+        free(c);
+        return NULL;
+    }
 
     /* ================================================================== */
     /*  PRE-REGISTER iovec buffers                                        */
@@ -112,227 +209,231 @@ static void *client_handler(void *arg)
     /*  the buffer addresses and lengths never change across iterations,   */
     /*  we avoid re-initialising the iovec on every send — this is the    */
     /*  "pre-registration" that makes sendmsg() efficient.                */
+    /*  With a single-block --alloc, adjacent fields share one entry.     */
     /* ================================================================== */
-    struct iovec iov[NUM_FIELDS];
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        iov[i].iov_base = msg.field[i];
-        iov[i].iov_len  = per_field + ((i == NUM_FIELDS - 1) ? remainder : 0);
+    c->n_iov = message_iov(&c->msg, layout, 0, layout->n_fields, c->iov);
+    for (int m = 1; m < c->iov_cap; m++) {
+        memcpy(&c->iov[m * c->n_iov], c->iov,
+               sizeof(c->iov[0]) * (size_t)c->n_iov);
     }
 
     /* ---- Prepare msghdr (reused across all sends) --------------------- */
-    struct msghdr mh;
-    memset(&mh, 0, sizeof(mh));
-    mh.msg_name       = NULL;         /* Connected socket — no address    */
-    mh.msg_namelen    = 0;
-    mh.msg_iov        = iov;          /* Pre-registered scatter array     */
-    mh.msg_iovlen     = NUM_FIELDS;   /* 8 entries                        */
-    mh.msg_control    = NULL;         /* No ancillary data                */
-    mh.msg_controllen = 0;
-    mh.msg_flags      = 0;
-
-    /* ---- Counters ----------------------------------------------------- */
-    size_t total_bytes_sent = 0;
-    size_t total_messages   = 0;
-    double start_time       = get_time_us();
-
-    /* ---- Main send loop ----------------------------------------------- */
-    while (g_running) {
-        /*
-         * =================================================================
-         *  ONE-COPY SEND — sendmsg() with pre-registered iovec
-         * =================================================================
-         *
-         *  sendmsg() receives the entire iovec array in a SINGLE system
-         *  call.  The kernel iterates over all 8 iov entries and performs
-         *  ONE consolidated copy from user-space into the kernel socket
-         *  buffer (sk_buff chain).
-         *
-         *  COPY ELIMINATED:
-         *  In Part A1, each send() call independently transitions into
-         *  kernel mode and copies one field.  Here, ALL 8 fields are
-         *  gathered in one pass — the per-field system-call and copy
-         *  overhead is eliminated.  The kernel sees the full scatter
-         *  list and can optimise the copy (e.g., page-pinning, gather
-         *  DMA on capable NICs).
-         *
-         *  NOTE: We do NOT use MSG_ZEROCOPY here.  The kernel still
-         *  copies data from user-space pages into sk_buffs, but it does
-         *  so in a single, consolidated operation rather than one per
-         *  field.
-         * =================================================================
-         */
-        ssize_t ret = sendmsg(client_fd, &mh, MSG_NOSIGNAL);
-
-        if (ret <= 0) {
-            if (ret == 0) {
-                printf("[Server-A2] Thread %lu: client disconnected\n",
-                       (unsigned long)pthread_self());
-            } else if (errno == EINTR) {
-                continue;   /* Signal interrupted, retry */
-            } else if (errno == EPIPE || errno == ECONNRESET) {
-                printf("[Server-A2] Thread %lu: client gone (%s)\n",
-                       (unsigned long)pthread_self(), strerror(errno));
-            } else {
-                perror("[Server-A2] sendmsg");
-            }
-            break;
-        }
-
-        /*
-         * sendmsg() may send fewer bytes than requested (partial send).
-         * For simplicity in this benchmark, we count only complete sends;
-         * a production implementation would advance iov offsets for the
-         * remainder.
-         */
-        total_bytes_sent += (size_t)ret;
-        if ((size_t)ret == msg_size) {
-            total_messages++;
-        }
-    }
-
-    /* ---- Report per-thread statistics --------------------------------- */
-    double elapsed_us   = get_time_us() - start_time;
-    double elapsed_s    = elapsed_us / 1e6;
-    double throughput   = (elapsed_s > 0.0)
-        ? ((double)total_bytes_sent * 8.0) / (elapsed_s * 1e9)
-        : 0.0;
-
-    printf("[Server-A2] Thread %lu: sent %zu msgs (%zu bytes) in %.2f s "
-           "— %.4f Gbps\n",
-           (unsigned long)pthread_self(),
-           total_messages, total_bytes_sent, elapsed_s, throughput);
-
-    /* ---- Cleanup ------------------------------------------------------ */
-    free_message(&msg);
-    close(client_fd);
-
-    return NULL;
+    memset(&c->mh, 0, sizeof(c->mh));
+    c->mh.msg_name       = NULL;        /* Connected socket — no address    */
+    c->mh.msg_namelen    = 0;
+    c->mh.msg_iov        = c->iov;      /* Pre-registered scatter array     */
+    c->mh.msg_iovlen     = (size_t)c->n_iov; /* Entries per message         */
+    c->mh.msg_control    = NULL;        /* No ancillary data                */
+    c->mh.msg_controllen = 0;
+    c->mh.msg_flags      = 0;
+
+    c->start_time = get_time_us();
+    return c;
 }
 
 // ===========================================================================
-//  main
+//  a2_queue
 // ===========================================================================
-int main(int argc, char *argv[])
+//  Batch mode: queues one more message and returns true once a budget
+//  says the batch must be flushed.
+// ---------------------------------------------------------------------------
+static bool a2_queue(a2_conn_t *c)
 {
-    /* ---- Parse command-line arguments --------------------------------- */
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <port> <message_size_bytes>\n", argv[0]);
-        return EXIT_FAILURE;
+    c->batch_n++;
+
+    if (c->batch_n >= g_batch_msgs) {
+        c->flush_count++;
+    } else if (g_batch_bytes > 0 &&
+               (size_t)c->batch_n * c->msg_size >= g_batch_bytes) {
+        c->flush_bytes++;
+    } else {
+        return false;
     }
+    return true;
+}
 
-    int    port     = atoi(argv[1]);
-    size_t msg_size = (size_t)atol(argv[2]);
-
-    if (port <= 0 || port > 65535) {
-        fprintf(stderr, "[Server-A2] Invalid port: %d\n", port);
-        return EXIT_FAILURE;
-    }
-    if (msg_size == 0) {
-        fprintf(stderr, "[Server-A2] Message size must be > 0\n");
-        return EXIT_FAILURE;
-    }
+// ===========================================================================
+//  a2_step
+// ===========================================================================
+//  Issues ONE sendmsg() for the (remainder of the) current message — or,
+//  in batch mode, queues a message and sends the batch once it is due.
+// ---------------------------------------------------------------------------
+static conn_status_t a2_step(void *arg)
+{
+    a2_conn_t *c = (a2_conn_t *)arg;
 
-    printf("[Server-A2] One-Copy Optimised (sendmsg + iovec)\n");
-    printf("[Server-A2] Port: %d | Message size: %zu bytes\n", port, msg_size);
-
-    /* ---- Install SIGINT handler --------------------------------------- */
-    struct sigaction sa;
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = sigint_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    if (sigaction(SIGINT, &sa, NULL) < 0) {
-        perror("[Server-A2] sigaction");
-        return EXIT_FAILURE;
+    if (g_batch_msgs > 1 && !c->flushing) {
+        if (!a2_queue(c)) {
+            return CONN_PROGRESS;   /* Keep gathering */
+        }
+        c->flushing = true;
     }
-    signal(SIGPIPE, SIG_IGN);
 
-    /* ---- Create listening socket -------------------------------------- */
-    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (listen_fd < 0) {
-        perror("[Server-A2] socket");
-        return EXIT_FAILURE;
+    /*
+     * A new message (or batch) starts at the head of the pre-registered
+     * array.  After a short send the cursor has trimmed the first unsent
+     * entry in place, so the next sendmsg() resumes exactly there.
+     */
+    if (iov_cursor_done(&c->out)) {
+        int n_msgs = (g_batch_msgs > 1) ? c->batch_n : 1;
+        iov_cursor_start(&c->out, c->iov, n_msgs * c->n_iov, c->msg_size);
     }
 
-    int opt = 1;
-    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        perror("[Server-A2] setsockopt SO_REUSEADDR");
-        close(listen_fd);
-        return EXIT_FAILURE;
+    struct msghdr mh = c->mh;
+    mh.msg_iov    = c->out.iov;
+    mh.msg_iovlen = (size_t)c->out.iovcnt;
+
+    /*
+     * =====================================================================
+     *  ONE-COPY SEND — sendmsg() with pre-registered iovec
+     * =====================================================================
+     *
+     *  sendmsg() receives the entire iovec array in a SINGLE system
+     *  call.  The kernel iterates over all 8 iov entries and performs
+     *  ONE consolidated copy from user-space into the kernel socket
+     *  buffer (sk_buff chain).
+     *
+     *  COPY ELIMINATED:
+     *  In Part A1, each send() call independently transitions into
+     *  kernel mode and copies one field.  Here, ALL 8 fields are
+     *  gathered in one pass — the per-field system-call and copy
+     *  overhead is eliminated.  The kernel sees the full scatter
+     *  list and can optimise the copy (e.g., page-pinning, gather
+     *  DMA on capable NICs).
+     *
+     *  NOTE: We do NOT use MSG_ZEROCOPY here.  The kernel still
+     *  copies data from user-space pages into sk_buffs, but it does
+     *  so in a single, consolidated operation rather than one per
+     *  field.
+     * =====================================================================
+     */
+    ssize_t ret = sendmsg(c->fd, &mh, MSG_NOSIGNAL);
+    c->sendmsg_calls++;
+
+    if (ret <= 0) {
+        if (ret == 0) {
+            printf("[Server-A2] Thread %lu: client disconnected\n",
+                   (unsigned long)pthread_self());
+            return CONN_CLOSED;
+        }
+        if (errno == EINTR) {
+            return CONN_PROGRESS;   /* Signal interrupted, retry */
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return CONN_BLOCKED;    /* Send buffer full (epoll mode) */
+        }
+        if (errno == EPIPE || errno == ECONNRESET) {
+            printf("[Server-A2] Thread %lu: client gone (%s)\n",
+                   (unsigned long)pthread_self(), strerror(errno));
+        } else {
+            perror("[Server-A2] sendmsg");
+        }
+        return CONN_CLOSED;
     }
 
-    /* ---- Bind --------------------------------------------------------- */
-    struct sockaddr_in serv_addr;
-    memset(&serv_addr, 0, sizeof(serv_addr));
-    serv_addr.sin_family      = AF_INET;
-    serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    serv_addr.sin_port        = htons((uint16_t)port);
-
-    if (bind(listen_fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
-        perror("[Server-A2] bind");
-        close(listen_fd);
-        return EXIT_FAILURE;
+    /*
+     * sendmsg() may send fewer bytes than requested (partial send).  The
+     * cursor carries the position to the next step so the byte stream
+     * stays a sequence of complete, in-order messages, and only messages
+     * whose last byte was accepted are counted.
+     */
+    c->total_bytes_sent += (size_t)ret;
+    c->total_messages   += iov_cursor_advance(&c->out, (size_t)ret);
+    if (g_batch_msgs > 1 && iov_cursor_done(&c->out)) {
+        int b = 0;
+        while ((c->batch_n >> (b + 1)) > 0 && b < BATCH_HIST - 1) {
+            b++;
+        }
+        c->batch_hist[b]++;
+        c->batch_n  = 0;
+        c->flushing = false;
     }
 
-    /* ---- Listen ------------------------------------------------------- */
-    if (listen(listen_fd, BACKLOG) < 0) {
-        perror("[Server-A2] listen");
-        close(listen_fd);
-        return EXIT_FAILURE;
-    }
+    return CONN_PROGRESS;
+}
 
-    printf("[Server-A2] Listening on port %d … (Ctrl+C to stop)\n", port);
+// ===========================================================================
+//  a2_close
+// ===========================================================================
+static void a2_close(void *arg)
+{
+    a2_conn_t *c = (a2_conn_t *)arg;
 
-    /* ---- Accept loop -------------------------------------------------- */
-    while (g_running) {
-        struct sockaddr_in client_addr;
-        socklen_t addr_len = sizeof(client_addr);
+    /* ---- Report per-connection statistics ----------------------------- */
+    double elapsed_us   = get_time_us() - c->start_time;
+    double elapsed_s    = elapsed_us / 1e6;
+    double throughput   = (elapsed_s > 0.0)
+        ? ((double)c->total_bytes_sent * 8.0) / (elapsed_s * 1e9)
+        : 0.0;
 
-        int client_fd = accept(listen_fd,
-                               (struct sockaddr *)&client_addr,
-                               &addr_len);
+    printf("[Server-A2] Thread %lu: sent %zu msgs (%zu bytes) in %.2f s "
+           "— %.4f Gbps\n",
+           (unsigned long)pthread_self(),
+           c->total_messages, c->total_bytes_sent, elapsed_s, throughput);
+    printf("[Server-A2] Thread %lu: %zu of %zu sendmsg calls were partial\n",
+           (unsigned long)pthread_self(),
+           c->out.partial_writes, c->out.writes);
+
+    size_t segs;
+    if (get_tcp_data_segs_out(c->fd, &segs) == 0 && segs > 0) {
+        printf("[Server-A2] Thread %lu: %zu TCP data segments, "
+               "%.0f bytes/segment\n",
+               (unsigned long)pthread_self(), segs,
+               (double)c->total_bytes_sent / (double)segs);
+    }
 
-        if (client_fd < 0) {
-            if (errno == EINTR) {
-                continue;
+    if (g_batch_msgs > 1) {
+        printf("[Server-A2] Thread %lu: %zu sendmsg calls, %.2f msgs/call; "
+               "flushes: %zu full, %zu bytes\n",
+               (unsigned long)pthread_self(), c->sendmsg_calls,
+               (c->sendmsg_calls > 0)
+                   ? (double)c->total_messages / (double)c->sendmsg_calls
+                   : 0.0,
+               c->flush_count, c->flush_bytes);
+        printf("[Server-A2] Thread %lu: batch sizes:",
+               (unsigned long)pthread_self());
+        for (int b = 0; b < BATCH_HIST; b++) {
+            int lo = 1 << b;
+            if (lo > g_batch_msgs) {
+                break;
+            }
+            int hi = (2 * lo - 1 < g_batch_msgs) ? 2 * lo - 1 : g_batch_msgs;
+            if (lo == hi) {
+                printf(" %d:%zu", lo, c->batch_hist[b]);
+            } else {
+                printf(" %d-%d:%zu", lo, hi, c->batch_hist[b]);
             }
-            perror("[Server-A2] accept");
-            continue;
-        }
-
-        printf("[Server-A2] Accepted connection from %s:%d (fd=%d)\n",
-               inet_ntoa(client_addr.sin_addr),
-               ntohs(client_addr.sin_port),
-               client_fd);
-
-        /* Disable Nagle */
-        int flag = 1;
-        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
-
-        /* Heap-allocate thread args — thread frees them */
-        thread_args_t *targs = (thread_args_t *)malloc(sizeof(thread_args_t));
-        if (targs == NULL) {
-            perror("[Server-A2] malloc thread_args");
-            close(client_fd);
-            continue;
-        }
-        targs->sock_fd      = client_fd;
-        targs->msg_size     = msg_size;
-        targs->duration_sec = 0;
-
-        pthread_t tid;
-        if (pthread_create(&tid, NULL, client_handler, targs) != 0) {
-            perror("[Server-A2] pthread_create");
-            free(targs);
-            close(client_fd);
-            continue;
         }
-        pthread_detach(tid);
+        printf("\n");
     }
 
-    /* ---- Shutdown ----------------------------------------------------- */
-    printf("\n[Server-A2] Shutting down …\n");
-    close(listen_fd);
+    /* ---- Cleanup ------------------------------------------------------ */
+    free(c->iov);
+    free_message(&c->msg);
+    close(c->fd);
+    free(c);
+}
+
+static const conn_ops_t a2_ops = {
+    .tag         = "[Server-A2]",
+    .banner      = "One-Copy Optimised (sendmsg + iovec)",
+    .open        = a2_open,
+    .step        = a2_step,
+    .on_error    = NULL,
+    .close       = a2_close,
+    .extra_opts  = a2_long_opts,
+    .extra_short = "b:B:",
+    .extra_usage = "  -b, --batch K             up to K messages per sendmsg() "
+                   "(default: 1)\n"
+                   "  -B, --batch-bytes B       flush once B bytes are queued\n",
+    .parse_opt   = a2_parse_opt,
+    .init        = a2_init,
+};
 
-    return EXIT_SUCCESS;
+// ===========================================================================
+//  main
+// ===========================================================================
+int main(int argc, char *argv[])
+{
+    return server_main(argc, argv, &a2_ops);
 }
@@ -57,31 +57,35 @@
 //    A3 (zero-copy): page-pin (no copy)  +  direct DMA    =  0 copies
 //   ────────────────────────────────────────────────────────────────────────
 //
+// Buffer ring (--ring K):
+// =======================
+//   By default one message is resent for the whole run — safe only because
+//   its content never changes while the kernel still references its pages.
+//   With --ring K each connection rotates through K messages and stamps
+//   fresh content into every new one.  Every successful MSG_ZEROCOPY
+//   sendmsg() is numbered by the kernel (0, 1, 2, ... per socket); a slot
+//   remembers the numbers its message was sent under and only returns to
+//   the free list once the error queue has reported all of them complete.
+//   If every slot is still in flight the sender waits for completions.
+//
 // Usage:
-//   ./MT25082_Part_A3_Server <port> <message_size_bytes>
+//   ./MT25082_Part_A3_Server [--mode thread|epoll] [--ring K]
+//                            [--fallback R] [--adaptive auto|BYTES]
+//                            [--profile P] [--hybrid BYTES]
+//                            <port> <message_size_bytes>
 //
 // Prerequisites:
 //   • Linux kernel ≥ 4.14 (MSG_ZEROCOPY support for TCP).
 //   • SO_ZEROCOPY socket option must be enabled on the socket.
 // =============================================================================
 
-#include "MT25082_common.h"
+#include "MT25082_server.h"
 
 // ---------------------------------------------------------------------------
 //  Additional headers required for zero-copy error-queue processing
 // ---------------------------------------------------------------------------
 #include <linux/errqueue.h>     /* SO_EE_ORIGIN_ZEROCOPY, sock_extended_err */
-
-// ---------------------------------------------------------------------------
-//  Global flag for clean SIGINT shutdown
-// ---------------------------------------------------------------------------
-static volatile sig_atomic_t g_running = 1;
-
-static void sigint_handler(int signo)
-{
-    (void)signo;
-    g_running = 0;
-}
+#include <poll.h>               /* poll (wait for error-queue notifications) */
 
 // ===========================================================================
 //  drain_completions
@@ -98,11 +102,19 @@ static void sigint_handler(int signo)
 //      sock_fd          – the connected socket
 //      pending_count    – pointer to the outstanding zero-copy send counter;
 //                         decremented for each notification received
+//      on_range         – called with each completed [lo, hi] range of
+//                         send sequence numbers and whether the kernel
+//                         fell back to copying for it, or NULL
+//      ctx              – passed through to on_range
 //
 //  Returns:
 //      Number of completions drained (0 if none available).
 // ---------------------------------------------------------------------------
-static int drain_completions(int sock_fd, size_t *pending_count)
+typedef void (*zc_range_fn)(void *ctx, uint32_t lo, uint32_t hi,
+                            bool copied);
+
+static int drain_completions(int sock_fd, size_t *pending_count,
+                             zc_range_fn on_range, void *ctx)
 {
     int completions = 0;
 
@@ -160,16 +172,30 @@ static int drain_completions(int sock_fd, size_t *pending_count)
             }
 
             /*
-             * serr->ee_info  = highest completed send counter
-             * serr->ee_data  = lowest  completed send counter
+             * serr->ee_info  = lowest  completed send counter
+             * serr->ee_data  = highest completed send counter
              *
-             * The range [ee_data .. ee_info] tells us how many
-             * zero-copy sends have been fully transmitted.
+             * The inclusive range [ee_info .. ee_data] tells us which
+             * zero-copy sends have been fully transmitted.  The kernel
+             * coalesces consecutive completions into one notification.
              */
-            uint32_t lo = serr->ee_data;
-            uint32_t hi = serr->ee_info;
+            uint32_t lo = serr->ee_info;
+            uint32_t hi = serr->ee_data;
             uint32_t range = hi - lo + 1;
 
+            /*
+             * SO_EE_CODE_ZEROCOPY_COPIED: the kernel could not keep the
+             * pages referenced (e.g. the data was looped back to a local
+             * receiver, as over loopback/veth) and copied them after all.
+             * The pinning was wasted work.  A coalesced range carries
+             * one code for all its sends.
+             */
+            bool copied = (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+
+            if (on_range != NULL) {
+                on_range(ctx, lo, hi, copied);
+            }
+
             if (*pending_count >= range) {
                 *pending_count -= range;
             } else {
@@ -183,23 +209,346 @@ static int drain_completions(int sock_fd, size_t *pending_count)
     return completions;
 }
 
+// ---------------------------------------------------------------------------
+//  Server-specific options
+// ---------------------------------------------------------------------------
+static unsigned g_ring_slots = 0;       /* 0 = one static message            */
+static double   g_fallback   = 0.0;     /* Copied ratio that disables zc     */
+static bool     g_adaptive   = false;   /* Choose copy / zc per sendmsg()    */
+static bool     g_calibrate  = false;   /* --adaptive auto                   */
+
+/*
+ * Sends of at least this many bytes use MSG_ZEROCOPY in adaptive mode.
+ * Read by every connection and changed by SIGUSR1 / SIGUSR2, so it is
+ * only accessed through __atomic builtins.
+ */
+static size_t   g_zc_threshold = 0;
+
+static size_t   g_hybrid     = 0;       /* Fields < this are copied (0 = off)*/
+
+/* "Never zero-copy": larger than any message the server is run with */
+#define ZC_THRESHOLD_MAX ((size_t)1 << 30)
+
+/* Completed sends needed before the copied ratio is trusted */
+#define ZC_FALLBACK_MIN_SENDS 1024
+
+static const struct option a3_long_opts[] = {
+    { "ring",     required_argument, NULL, 'k' },
+    { "fallback", required_argument, NULL, 'f' },
+    { "adaptive", required_argument, NULL, 'a' },
+    { "hybrid",   required_argument, NULL, 'y' },
+    { NULL,       0,                 NULL,  0  }
+};
+
+static int a3_parse_opt(int c, const char *arg)
+{
+    switch (c) {
+    case 'k':
+        g_ring_slots = (unsigned)atoi(arg);
+        if (g_ring_slots == 0 || g_ring_slots > 4096) {
+            fprintf(stderr, "[Server-A3] Ring size must be 1..4096\n");
+            return -1;
+        }
+        return 0;
+    case 'f':
+        g_fallback = atof(arg);
+        if (!(g_fallback > 0.0 && g_fallback <= 1.0)) {
+            fprintf(stderr, "[Server-A3] Fallback ratio must be in (0, 1]\n");
+            return -1;
+        }
+        return 0;
+    case 'a':
+        g_adaptive = true;
+        if (strcmp(arg, "auto") == 0) {
+            g_calibrate = true;
+            return 0;
+        }
+        g_zc_threshold = (size_t)strtoull(arg, NULL, 10);
+        if (g_zc_threshold == 0 || g_zc_threshold > ZC_THRESHOLD_MAX) {
+            fprintf(stderr, "[Server-A3] --adaptive takes 'auto' or a size "
+                    "in bytes (1..%zu)\n", ZC_THRESHOLD_MAX);
+            return -1;
+        }
+        return 0;
+    case 'y':
+        g_hybrid = (size_t)strtoull(arg, NULL, 10);
+        if (g_hybrid == 0) {
+            fprintf(stderr, "[Server-A3] --hybrid takes a field size in "
+                    "bytes (> 0)\n");
+            return -1;
+        }
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+// ===========================================================================
+//  a3_run_t
+// ===========================================================================
+//  A run of consecutive fields sent by one sendmsg() (plus resumptions of
+//  a short send).  Without --hybrid the whole message is a single
+//  zero-copy run.  With --hybrid, fields smaller than the threshold form
+//  copied runs and the others zero-copy runs; every run but the last is
+//  sent with MSG_MORE, so a copied header run is coalesced into the same
+//  segment as the payload that follows instead of leaving on its own.
+// ---------------------------------------------------------------------------
+typedef struct {
+    int    first;                       /* First field of the run            */
+    int    n;                           /* Fields in the run                 */
+    size_t len;                         /* Bytes in the run                  */
+    bool   zc;                          /* Large fields: MSG_ZEROCOPY        */
+} a3_run_t;
+
+/* Runs of the --profile layout, shared by every connection (a3_init) */
+static a3_run_t *g_runs   = NULL;
+static int       g_n_runs = 0;
+
+/*
+ * Where each run sits in a slot's iovec.  message_iov() may merge
+ * adjacent fields of a run into one entry, so run r covers entries
+ * [first, first + n) rather than its field range.  Every slot of a
+ * connection is allocated the same way and shares one span table.
+ */
+typedef struct {
+    int first;                          /* First iovec entry of the run      */
+    int n;                              /* Entries in the run                */
+} a3_span_t;
+
+// ---------------------------------------------------------------------------
+//  a3_build_runs — splits the message layout into runs (room for one per
+//  field); returns the run count.  Empty fields never start a run, so no
+//  run is empty.
+// ---------------------------------------------------------------------------
+static int a3_build_runs(const msg_layout_t *layout, a3_run_t *runs)
+{
+    int n = 0;
+
+    for (int i = 0; i < layout->n_fields; i++) {
+        size_t len = layout->size[i];
+        bool   zc  = (g_hybrid == 0) || (len >= g_hybrid);
+
+        if (len == 0 || (n > 0 && runs[n - 1].zc == zc)) {
+            if (n > 0) {
+                runs[n - 1].n++;
+                runs[n - 1].len += len;
+            }
+        } else {
+            runs[n].first = i;
+            runs[n].n     = 1;
+            runs[n].len   = len;
+            runs[n].zc    = zc;
+            n++;
+        }
+    }
+    return n;
+}
+
 // ===========================================================================
-//  client_handler
+//  a3_slot_t
 // ===========================================================================
-//  Thread entry point.  Uses MSG_ZEROCOPY sendmsg() with pre-registered
-//  iovec buffers.  Tracks outstanding zero-copy sends and drains the error
-//  queue periodically to prevent unbounded kernel resource consumption.
+//  One message buffer.  [seq_lo .. seq_hi] are the zero-copy sequence
+//  numbers of its most recent send (several if the message went out in
+//  short sends); in_flight counts those not yet reported complete.
+//  A slot is free again once it is neither being sent nor in flight.
 // ---------------------------------------------------------------------------
-static void *client_handler(void *arg)
+typedef struct {
+    message_t    msg;
+    struct iovec *iov;                  /* Runs' entries (see a3_span_t)     */
+    uint32_t     seq_lo;
+    uint32_t     seq_hi;
+    uint32_t     in_flight;
+    bool         sending;
+} a3_slot_t;
+
+// ===========================================================================
+//  a3_conn_t
+// ===========================================================================
+//  Per-connection send state: the message slot(s), the resume cursor for
+//  short sends, and the count of zero-copy sends whose completion
+//  notification has not been drained yet.
+// ---------------------------------------------------------------------------
+typedef struct {
+    int           fd;                   /* Connected socket                  */
+    bool          nonblocking;          /* true in epoll mode                */
+    size_t        msg_size;             /* Total message size (bytes)        */
+    a3_slot_t    *slots;                /* 1 static message, or the ring     */
+    unsigned      n_slots;
+    bool          ring;                 /* --ring: rotate + refresh content  */
+    unsigned     *free_list;            /* Stack of free slot indices        */
+    unsigned      n_free;
+    a3_slot_t    *cur;                  /* Slot being sent                   */
+    a3_span_t    *spans;                /* iovec entries of each g_runs[r]   */
+    struct msghdr mh;                   /* Reused across all sends           */
+    int           run_idx;              /* Run of g_runs being sent          */
+    size_t        msg_off;              /* Bytes of current message sent     */
+    iov_cursor_t  out;                  /* Position inside the current run   */
+    uint32_t      next_seq;             /* Kernel's number for the next send */
+    bool          zc;                   /* Still sending with MSG_ZEROCOPY   */
+    size_t        pending_zc;           /* Zero-copy sends still in flight   */
+    size_t        done_zc;              /* Completions sent by zero-copy     */
+    size_t        done_copied;          /* ...where the kernel copied anyway */
+    size_t        fallback_msg;         /* Message number at fallback        */
+    size_t        copy_sends;           /* Plain sendmsg() calls             */
+    size_t        bytes_zc;             /* Sent with MSG_ZEROCOPY            */
+    size_t        bytes_copy;           /* Sent with plain sendmsg()         */
+    size_t        drain_threshold;      /* Drain once this many are pending  */
+    size_t        pending_peak;         /* Metric: max pending_zc            */
+    double        pending_sum;          /* Metric: sum of pending_zc / send  */
+    size_t        ring_stalls;          /* Waits for a slot to complete      */
+    size_t        zc_waits;             /* poll()s for a notification        */
+    double        zc_wait_us;           /* Time blocked in those poll()s     */
+    size_t        total_bytes_sent;
+    size_t        total_messages;
+    double        start_time;
+    double        start_cpu;            /* Thread CPU seconds at open        */
+} a3_conn_t;
+
+/*
+ * Every un-drained notification holds an skb charged to the socket's
+ * optmem budget (net.core.optmem_max); sendmsg() fails with ENOBUFS once
+ * the budget is spent.  ZC_NOTIF_TRUESIZE approximates that charge
+ * (SKB_TRUESIZE(0) on 64-bit kernels).
+ */
+#define ZC_NOTIF_TRUESIZE    576
+#define ZC_DRAIN_DEFAULT     256    /* If optmem_max cannot be read          */
+#define ZC_WAIT_MS           100    /* poll() timeout to re-check g_running  */
+#define ZC_CLOSE_TIMEOUT_MS  1000   /* Max wait for completions at close     */
+
+// ===========================================================================
+//  zc_drain_threshold
+// ===========================================================================
+//  Drain once half of the optmem budget is used by pending notifications,
+//  i.e. well before sendmsg() would hit ENOBUFS.
+// ---------------------------------------------------------------------------
+static size_t zc_drain_threshold(void)
 {
-    /* ---- Unpack per-thread arguments ---------------------------------- */
-    thread_args_t *targs = (thread_args_t *)arg;
-    int    client_fd = targs->sock_fd;
-    size_t msg_size  = targs->msg_size;
-    free(targs);
+    long  optmem = 0;
+    FILE *f      = fopen("/proc/sys/net/core/optmem_max", "r");
+    if (f != NULL) {
+        if (fscanf(f, "%ld", &optmem) != 1) {
+            optmem = 0;
+        }
+        fclose(f);
+    }
+    if (optmem <= 0) {
+        return ZC_DRAIN_DEFAULT;
+    }
 
-    printf("[Server-A3] Thread %lu: handling client fd=%d, msg_size=%zu\n",
-           (unsigned long)pthread_self(), client_fd, msg_size);
+    size_t half = (size_t)optmem / ZC_NOTIF_TRUESIZE / 2;
+    return (half > 0) ? half : 1;
+}
+
+// ===========================================================================
+//  a3_on_range
+// ===========================================================================
+//  zc_range_fn for drain_completions().  Counts the completed sends as
+//  zero-copy or copied, and switches the connection to plain sendmsg()
+//  once the copied share reaches --fallback.
+//
+//  Ring mode: credits the completed sequence numbers [lo .. hi] to the
+//  slots that were sent under them and frees the slots with nothing left
+//  in flight.  Comparisons are done relative to `lo` so the 32-bit
+//  counter may wrap.
+// ---------------------------------------------------------------------------
+static void a3_on_range(void *ctx, uint32_t lo, uint32_t hi, bool copied)
+{
+    a3_conn_t *c    = (a3_conn_t *)ctx;
+    uint32_t   span = hi - lo;
+
+    if (copied) {
+        c->done_copied += (size_t)span + 1;
+    } else {
+        c->done_zc     += (size_t)span + 1;
+    }
+
+    size_t done = c->done_zc + c->done_copied;
+    if (c->zc && g_fallback > 0.0 && done >= ZC_FALLBACK_MIN_SENDS &&
+        (double)c->done_copied >= g_fallback * (double)done) {
+        c->zc           = false;
+        c->fallback_msg = c->total_messages;
+        printf("[Server-A3] Thread %lu: %.1f%% of zero-copy sends were "
+               "copied — falling back to plain sendmsg()\n",
+               (unsigned long)pthread_self(),
+               100.0 * (double)c->done_copied / (double)done);
+    }
+
+    if (!c->ring) {
+        return;
+    }
+
+    for (unsigned s = 0; s < c->n_slots; s++) {
+        a3_slot_t *slot = &c->slots[s];
+        if (slot->in_flight == 0) {
+            continue;
+        }
+        for (uint32_t q = slot->seq_lo; ; q++) {
+            if ((uint32_t)(q - lo) <= span && slot->in_flight > 0) {
+                slot->in_flight--;
+            }
+            if (q == slot->seq_hi) {
+                break;
+            }
+        }
+        if (slot->in_flight == 0 && !slot->sending) {
+            c->free_list[c->n_free++] = s;
+        }
+    }
+}
+
+// ===========================================================================
+//  a3_drain
+// ===========================================================================
+static int a3_drain(a3_conn_t *c)
+{
+    return drain_completions(c->fd, &c->pending_zc, a3_on_range, c);
+}
+
+// ===========================================================================
+//  a3_wait_completions
+// ===========================================================================
+//  Thread mode: blocks in poll() until the error queue holds a completion
+//  notification (reported as POLLERR), then drains it — the sender waits
+//  exactly as long as the kernel takes, with no fixed back-off.
+//
+//  Returns false if the peer is gone (POLLHUP / socket error with nothing
+//  to drain) or poll() fails.
+// ---------------------------------------------------------------------------
+static bool a3_wait_completions(a3_conn_t *c, int timeout_ms)
+{
+    struct pollfd pfd = { .fd = c->fd, .events = 0 };
+
+    double t0 = get_time_us();
+    int    n  = poll(&pfd, 1, timeout_ms);
+    c->zc_wait_us += get_time_us() - t0;
+    c->zc_waits++;
+
+    if (n < 0) {
+        if (errno == EINTR) {
+            return true;
+        }
+        perror("[Server-A3] poll");
+        return false;
+    }
+
+    int drained = a3_drain(c);
+    if (drained == 0 && (pfd.revents & (POLLERR | POLLHUP))) {
+        return false;
+    }
+    return true;
+}
+
+// ===========================================================================
+//  a3_open
+// ===========================================================================
+//  Enables SO_ZEROCOPY, allocates the message(s) and pre-registers each
+//  slot's iovec.
+// ---------------------------------------------------------------------------
+static void *a3_open(int fd, const server_opts_t *opts, bool nonblocking)
+{
+    printf("[Server-A3] Thread %lu: handling client fd=%d, msg_size=%zu, "
+           "ring=%u\n", (unsigned long)pthread_self(), fd, opts->msg_size,
+           g_ring_slots);
 
     /* ---- Enable SO_ZEROCOPY on the connected socket ------------------- */
     /*
@@ -208,43 +557,88 @@ static void *client_handler(void *arg)
      * direct DMA) instead of copying data into kernel buffers.
      */
     int zc_flag = 1;
-    if (setsockopt(client_fd, SOL_SOCKET, SO_ZEROCOPY,
+    if (setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY,
                    &zc_flag, sizeof(zc_flag)) < 0) {
         perror("[Server-A3] setsockopt SO_ZEROCOPY");
         fprintf(stderr, "[Server-A3] Kernel may not support MSG_ZEROCOPY "
                 "(requires Linux >= 4.14)\n");
-        close(client_fd);
         return NULL;
     }
 
-    /* ---- Allocate message on the heap (per-thread, private) ----------- */
-    message_t msg;
-    allocate_message(&msg, msg_size);
-    fill_message(&msg, msg_size);
+    a3_conn_t *c = (a3_conn_t *)calloc(1, sizeof(a3_conn_t));
+    if (c == NULL) {
+        perror("[Server-A3] malloc conn");
+        return NULL;
+    }
 
-    /* Pre-compute per-field sizes */
-    size_t per_field = msg_size / NUM_FIELDS;
-    size_t remainder = msg_size % NUM_FIELDS;
+    c->fd          = fd;
+    c->nonblocking = nonblocking;
+    c->msg_size    = opts->msg_size;
+    c->ring        = (g_ring_slots > 0);
+    c->n_slots     = c->ring ? g_ring_slots : 1;
 
-    /* ---- Pre-register iovec ------------------------------------------- */
-    struct iovec iov[NUM_FIELDS];
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        iov[i].iov_base = msg.field[i];
-        iov[i].iov_len  = per_field + ((i == NUM_FIELDS - 1) ? remainder : 0);
+    c->zc              = true;
+    c->drain_threshold = zc_drain_threshold();
+
+    c->slots     = (a3_slot_t *)calloc(c->n_slots, sizeof(a3_slot_t));
+    c->free_list = (unsigned *)calloc(c->n_slots, sizeof(unsigned));
+    c->spans     = (a3_span_t *)calloc((size_t)g_n_runs, sizeof(a3_span_t));
+    if (c->slots == NULL || c->free_list == NULL || c->spans == NULL) {
+        perror("[Server-A3] malloc ring");
+        free(c->slots);
+        free(c->free_list);
+        free(c->spans);
+        free(c);
+        return NULL;
+    }
+
+    /* ---- Allocate messages on the heap (per-connection, private) ------ */
+    const msg_layout_t *layout = &opts->layout;
+    for (unsigned s = 0; s < c->n_slots; s++) {
+        a3_slot_t *slot = &c->slots[s];
+        allocate_message_as(&slot->msg, layout, opts->alloc);
+        fill_message(&slot->msg, layout);
+        slot->iov = (struct iovec *)calloc((size_t)layout->n_fields,
+                                           sizeof(struct iovec));
+        if (slot->msg.field == NULL || slot->iov == NULL) {
+            perror("[Server-A3] malloc message");
+            for (unsigned t = 0; t <= s; t++) {
+                free_message(&c->slots[t].msg);
+                free(c->slots[t].iov);
+            }
+            free(c->slots);
+            free(c->free_list);
+            free(c->spans);
+            free(c);
+            return NULL;
+        }
+
+        /* ---- Pre-register iovec, run by run --------------------------- */
+        int k = 0;
+        for (int r = 0; r < g_n_runs; r++) {
+            c->spans[r].first = k;
+            c->spans[r].n     = message_iov(&slot->msg, layout,
+                                            g_runs[r].first, g_runs[r].n,
+                                            &slot->iov[k]);
+            k += c->spans[r].n;
+        }
+
+        /* Pop order 0, 1, 2, ... */
+        c->free_list[c->n_free++] = c->n_slots - 1 - s;
     }
+    c->cur = &c->slots[0];
 
     /* ---- Prepare msghdr (reused across all sends) --------------------- */
-    struct msghdr mh;
-    memset(&mh, 0, sizeof(mh));
-    mh.msg_name       = NULL;
-    mh.msg_namelen    = 0;
-    mh.msg_iov        = iov;
-    mh.msg_iovlen     = NUM_FIELDS;
-    mh.msg_control    = NULL;
-    mh.msg_controllen = 0;
-    mh.msg_flags      = 0;
-
-    /* ---- Per-thread zero-copy tracking -------------------------------- */
+    memset(&c->mh, 0, sizeof(c->mh));
+    c->mh.msg_name       = NULL;
+    c->mh.msg_namelen    = 0;
+    c->mh.msg_iov        = c->cur->iov;
+    c->mh.msg_iovlen     = (size_t)(c->spans[g_n_runs - 1].first +
+                                    c->spans[g_n_runs - 1].n);
+    c->mh.msg_control    = NULL;
+    c->mh.msg_controllen = 0;
+    c->mh.msg_flags      = 0;
+
     /*
      * pending_zc tracks how many zero-copy sends are "in flight" —
      * i.e., the kernel still has our pages pinned and the NIC hasn't
@@ -252,86 +646,233 @@ static void *client_handler(void *arg)
      * bounded and avoid exhausting kernel resources (pinned pages,
      * notification queue entries).
      */
-    size_t pending_zc       = 0;
-    size_t total_bytes_sent = 0;
-    size_t total_messages   = 0;
-    double start_time       = get_time_us();
-
-    /* Threshold: drain completions when this many are outstanding */
-    const size_t ZC_DRAIN_THRESHOLD = 256;
-
-    /* ---- Main send loop ----------------------------------------------- */
-    while (g_running) {
-
-        /*
-         * =================================================================
-         *  ZERO-COPY SEND — sendmsg() with MSG_ZEROCOPY
-         * =================================================================
-         *
-         *  When MSG_ZEROCOPY is set:
-         *    1. The kernel does NOT copy data from user-space buffers into
-         *       sk_buffs.
-         *    2. Instead, it pins the physical pages backing msg.field[0..7]
-         *       and creates sk_buff frags pointing to those pages.
-         *    3. The NIC DMA engine reads directly from the pinned user
-         *       pages into the hardware TX ring.
-         *    4. After DMA completes, the kernel unpins the pages and
-         *       delivers a completion notification on the error queue.
-         *
-         *  *** The user→kernel copy is COMPLETELY ELIMINATED. ***
-         *
-         *  Trade-off: page pinning + completion tracking adds latency for
-         *  small messages, so zero-copy is most beneficial for large
-         *  payloads where the copy cost would dominate.
-         * =================================================================
-         */
-        ssize_t ret = sendmsg(client_fd, &mh, MSG_ZEROCOPY | MSG_NOSIGNAL);
+    c->start_cpu  = get_thread_cpu_s();
+    c->start_time = get_time_us();
+    return c;
+}
 
-        if (ret < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            if (errno == ENOBUFS) {
-                /*
-                 * Too many zero-copy sends in flight — the kernel ran out
-                 * of notification slots.  Drain completions and retry.
-                 */
-                drain_completions(client_fd, &pending_zc);
-                usleep(100);    /* Brief back-off */
-                continue;
+// ===========================================================================
+//  a3_next_slot
+// ===========================================================================
+//  Ring mode, start of a message: claims a free slot and stamps the
+//  message number into it.  If every slot is still in flight, drains the
+//  error queue; returns false when nothing has completed yet.
+// ---------------------------------------------------------------------------
+static bool a3_next_slot(a3_conn_t *c)
+{
+    if (c->n_free == 0) {
+        a3_drain(c);
+        if (c->n_free == 0) {
+            c->ring_stalls++;
+            return false;
+        }
+    }
+
+    a3_slot_t *slot = &c->slots[c->free_list[--c->n_free]];
+    slot->sending   = true;
+    slot->in_flight = 0;
+    slot->seq_lo    = c->next_seq;
+
+    size_t stamp = c->total_messages;
+    size_t n     = (slot->iov[0].iov_len < sizeof(stamp))
+                   ? slot->iov[0].iov_len : sizeof(stamp);
+    memcpy(slot->iov[0].iov_base, &stamp, n);
+
+    c->cur = slot;
+    return true;
+}
+
+// ===========================================================================
+//  a3_step
+// ===========================================================================
+//  Issues ONE MSG_ZEROCOPY sendmsg() for the (remainder of the) current
+//  message, then drains the error queue once too many sends are pending.
+// ---------------------------------------------------------------------------
+static conn_status_t a3_step(void *arg)
+{
+    a3_conn_t *c = (a3_conn_t *)arg;
+
+    if (c->ring && c->msg_off == 0 && !c->cur->sending) {
+        if (!a3_next_slot(c)) {
+            /*
+             * Every buffer is still referenced by the kernel.  In epoll
+             * mode the next notification arrives as EPOLLERR; in thread
+             * mode poll() for it.
+             */
+            if (c->nonblocking) {
+                return CONN_BLOCKED;
             }
-            if (errno == EPIPE || errno == ECONNRESET) {
-                printf("[Server-A3] Thread %lu: client gone (%s)\n",
-                       (unsigned long)pthread_self(), strerror(errno));
-            } else {
-                perror("[Server-A3] sendmsg MSG_ZEROCOPY");
+            if (!a3_wait_completions(c, ZC_WAIT_MS)) {
+                printf("[Server-A3] Thread %lu: client gone (waiting for "
+                       "completions)\n", (unsigned long)pthread_self());
+                return CONN_CLOSED;
             }
-            break;
+            return CONN_PROGRESS;
         }
+    }
 
-        if (ret == 0) {
-            printf("[Server-A3] Thread %lu: client disconnected\n",
-                   (unsigned long)pthread_self());
-            break;
+    /*
+     * Send the current run, resuming a short send where it stopped.  The
+     * kernel has pinned (or copied) the pages by the time sendmsg()
+     * returns, so trimming the slot's iovec in place is safe even while
+     * zero-copy sends of it are still in flight.
+     */
+    const a3_run_t  *run  = &g_runs[c->run_idx];
+    const a3_span_t *span = &c->spans[c->run_idx];
+    if (iov_cursor_done(&c->out)) {
+        iov_cursor_start(&c->out, &c->cur->iov[span->first], span->n, 0);
+    }
+
+    struct msghdr mh = c->mh;
+    mh.msg_iov    = c->out.iov;
+    mh.msg_iovlen = (size_t)c->out.iovcnt;
+
+    /*
+     * =====================================================================
+     *  ZERO-COPY SEND — sendmsg() with MSG_ZEROCOPY
+     * =====================================================================
+     *
+     *  When MSG_ZEROCOPY is set:
+     *    1. The kernel does NOT copy data from user-space buffers into
+     *       sk_buffs.
+     *    2. Instead, it pins the physical pages backing msg.field[0..7]
+     *       and creates sk_buff frags pointing to those pages.
+     *    3. The NIC DMA engine reads directly from the pinned user
+     *       pages into the hardware TX ring.
+     *    4. After DMA completes, the kernel unpins the pages and
+     *       delivers a completion notification on the error queue.
+     *
+     *  *** The user→kernel copy is COMPLETELY ELIMINATED. ***
+     *
+     *  Trade-off: page pinning + completion tracking adds latency for
+     *  small messages, so zero-copy is most beneficial for large
+     *  payloads where the copy cost would dominate.
+     * =====================================================================
+     */
+    bool use_zc = c->zc && run->zc;
+    if (use_zc && g_adaptive) {
+        use_zc = c->out.remaining >=
+                 __atomic_load_n(&g_zc_threshold, __ATOMIC_RELAXED);
+    }
+
+    int flags = use_zc ? (MSG_ZEROCOPY | MSG_NOSIGNAL) : MSG_NOSIGNAL;
+    if (c->run_idx + 1 < g_n_runs) {
+        flags |= MSG_MORE;      /* More of this message follows */
+    }
+    ssize_t ret = sendmsg(c->fd, &mh, flags);
+
+    if (ret < 0) {
+        if (errno == EINTR) {
+            return CONN_PROGRESS;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return CONN_BLOCKED;    /* Send buffer full (epoll mode) */
         }
+        if (errno == ENOBUFS) {
+            /*
+             * Too many zero-copy sends in flight — the kernel ran out
+             * of notification slots.  Drain completions and retry.  If
+             * nothing has completed yet, wait for the POLLERR / EPOLLERR
+             * that announces the next notification.
+             */
+            if (a3_drain(c) > 0) {
+                return CONN_PROGRESS;
+            }
+            if (c->nonblocking) {
+                return CONN_BLOCKED;
+            }
+            if (!a3_wait_completions(c, ZC_WAIT_MS)) {
+                printf("[Server-A3] Thread %lu: client gone (waiting for "
+                       "completions)\n", (unsigned long)pthread_self());
+                return CONN_CLOSED;
+            }
+            return CONN_PROGRESS;
+        }
+        if (errno == EPIPE || errno == ECONNRESET) {
+            printf("[Server-A3] Thread %lu: client gone (%s)\n",
+                   (unsigned long)pthread_self(), strerror(errno));
+        } else {
+            perror((flags & MSG_ZEROCOPY) ? "[Server-A3] sendmsg MSG_ZEROCOPY"
+                                          : "[Server-A3] sendmsg");
+        }
+        return CONN_CLOSED;
+    }
 
-        total_bytes_sent += (size_t)ret;
-        pending_zc++;
+    if (ret == 0) {
+        printf("[Server-A3] Thread %lu: client disconnected\n",
+               (unsigned long)pthread_self());
+        return CONN_CLOSED;
+    }
 
-        if ((size_t)ret == msg_size) {
-            total_messages++;
+    c->total_bytes_sent += (size_t)ret;
+
+    if (flags & MSG_ZEROCOPY) {
+        c->pending_zc++;
+        c->pending_sum += (double)c->pending_zc;
+        if (c->pending_zc > c->pending_peak) {
+            c->pending_peak = c->pending_zc;
+        }
+
+        /* The kernel numbered this send c->next_seq (one per call) */
+        if (c->ring) {
+            c->cur->seq_hi = c->next_seq;
+            c->cur->in_flight++;
         }
+        c->next_seq++;
+        c->bytes_zc += (size_t)ret;
+    } else {
+        c->copy_sends++;
+        c->bytes_copy += (size_t)ret;
+    }
 
-        /*
-         * Periodically drain the error queue to process zero-copy
-         * completion notifications.  This prevents unbounded growth
-         * of pinned pages and kernel notification structures.
-         */
-        if (pending_zc >= ZC_DRAIN_THRESHOLD) {
-            drain_completions(client_fd, &pending_zc);
+    c->msg_off += (size_t)ret;
+    iov_cursor_advance(&c->out, (size_t)ret);
+    if (iov_cursor_done(&c->out)) {
+        c->run_idx++;
+    }
+    if (c->msg_off == c->msg_size) {
+        c->msg_off = 0;
+        c->run_idx = 0;
+        c->total_messages++;
+        c->cur->sending = false;
+        if (c->ring && c->cur->in_flight == 0) {
+            /* Every part already completed while the tail was sent */
+            c->free_list[c->n_free++] = (unsigned)(c->cur - c->slots);
         }
     }
 
+    /*
+     * Periodically drain the error queue to process zero-copy
+     * completion notifications.  This prevents unbounded growth
+     * of pinned pages and kernel notification structures.
+     */
+    if (c->pending_zc >= c->drain_threshold) {
+        a3_drain(c);
+    }
+
+    return CONN_PROGRESS;
+}
+
+// ===========================================================================
+//  a3_on_error
+// ===========================================================================
+//  epoll reported EPOLLERR: completion notifications are queued.
+// ---------------------------------------------------------------------------
+static conn_status_t a3_on_error(void *arg)
+{
+    a3_conn_t *c = (a3_conn_t *)arg;
+
+    a3_drain(c);
+    return CONN_PROGRESS;
+}
+
+// ===========================================================================
+//  a3_close
+// ===========================================================================
+static void a3_close(void *arg)
+{
+    a3_conn_t *c = (a3_conn_t *)arg;
+
     /* ---- Drain any remaining completions before cleanup ---------------- */
     /*
      * We must wait for all outstanding zero-copy completions before
@@ -339,164 +880,387 @@ static void *client_handler(void *arg)
      * be DMA-ing from pages we're about to free — causing data corruption
      * or a kernel oops.
      */
-    int drain_retries = 0;
-    while (pending_zc > 0 && drain_retries < 1000) {
-        drain_completions(client_fd, &pending_zc);
-        if (pending_zc > 0) {
-            usleep(1000);   /* 1 ms back-off */
-            drain_retries++;
+    double deadline = get_time_us() + ZC_CLOSE_TIMEOUT_MS * 1000.0;
+    a3_drain(c);
+    while (c->pending_zc > 0) {
+        int left_ms = (int)((deadline - get_time_us()) / 1000.0);
+        if (left_ms <= 0 || !a3_wait_completions(c, left_ms)) {
+            break;
         }
     }
 
-    if (pending_zc > 0) {
+    if (c->pending_zc > 0) {
         fprintf(stderr, "[Server-A3] Thread %lu: WARNING — %zu completions "
                 "still outstanding after drain timeout\n",
-                (unsigned long)pthread_self(), pending_zc);
+                (unsigned long)pthread_self(), c->pending_zc);
     }
 
-    /* ---- Report per-thread statistics --------------------------------- */
-    double elapsed_us = get_time_us() - start_time;
+    /* ---- Report per-connection statistics ----------------------------- */
+    double elapsed_us = get_time_us() - c->start_time;
     double elapsed_s  = elapsed_us / 1e6;
     double throughput = (elapsed_s > 0.0)
-        ? ((double)total_bytes_sent * 8.0) / (elapsed_s * 1e9)
+        ? ((double)c->total_bytes_sent * 8.0) / (elapsed_s * 1e9)
         : 0.0;
 
     printf("[Server-A3] Thread %lu: sent %zu msgs (%zu bytes) in %.2f s "
            "— %.4f Gbps\n",
            (unsigned long)pthread_self(),
-           total_messages, total_bytes_sent, elapsed_s, throughput);
+           c->total_messages, c->total_bytes_sent, elapsed_s, throughput);
+    printf("[Server-A3] Thread %lu: %zu of %zu sendmsg calls were partial\n",
+           (unsigned long)pthread_self(),
+           c->out.partial_writes, c->out.writes);
 
-    /* ---- Cleanup ------------------------------------------------------ */
-    free_message(&msg);
-    close(client_fd);
+    size_t sends = c->next_seq;
+    printf("[Server-A3] Thread %lu: pending completions peak %zu, mean %.1f "
+           "(drain at %zu); %zu waits, %.1f ms blocked\n",
+           (unsigned long)pthread_self(), c->pending_peak,
+           (sends > 0) ? c->pending_sum / (double)sends : 0.0,
+           c->drain_threshold, c->zc_waits, c->zc_wait_us / 1000.0);
 
-    return NULL;
+    size_t done = c->done_zc + c->done_copied;
+    printf("[Server-A3] Thread %lu: completions %zu zero-copy, %zu copied "
+           "(%.1f%% copied)\n", (unsigned long)pthread_self(), c->done_zc,
+           c->done_copied,
+           (done > 0) ? 100.0 * (double)c->done_copied / (double)done : 0.0);
+    if (g_hybrid > 0 || g_adaptive) {
+        size_t bytes = c->bytes_zc + c->bytes_copy;
+        printf("[Server-A3] Thread %lu: %zu bytes zero-copy, %zu copied "
+               "(%.1f%% copied)\n", (unsigned long)pthread_self(),
+               c->bytes_zc, c->bytes_copy,
+               (bytes > 0) ? 100.0 * (double)c->bytes_copy / (double)bytes
+                           : 0.0);
+    }
+    if (g_adaptive) {
+        printf("[Server-A3] Thread %lu: adaptive: %u zero-copy sends, "
+               "%zu copied sends\n", (unsigned long)pthread_self(),
+               c->next_seq, c->copy_sends);
+    }
+    if (!c->zc) {
+        printf("[Server-A3] Thread %lu: fell back to plain sendmsg() after "
+               "%zu msgs\n", (unsigned long)pthread_self(), c->fallback_msg);
+    }
+
+    if (c->ring) {
+        printf("[Server-A3] Thread %lu: ring %u slots, %zu stalls "
+               "waiting for completions\n", (unsigned long)pthread_self(),
+               c->n_slots, c->ring_stalls);
+    }
+
+    /* The loop thread is shared in epoll mode — its CPU is not ours alone */
+    if (!c->nonblocking) {
+        double cpu_s = get_thread_cpu_s() - c->start_cpu;
+        printf("[Server-A3] Thread %lu: sender CPU %.2f s (%.3f s/GB)\n",
+               (unsigned long)pthread_self(), cpu_s,
+               (c->total_bytes_sent > 0)
+                   ? cpu_s * 1e9 / (double)c->total_bytes_sent : 0.0);
+    }
+
+    /* ---- Cleanup ------------------------------------------------------ */
+    for (unsigned s = 0; s < c->n_slots; s++) {
+        free_message(&c->slots[s].msg);
+        free(c->slots[s].iov);
+    }
+    free(c->slots);
+    free(c->free_list);
+    free(c->spans);
+    close(c->fd);
+    free(c);
 }
 
 // ===========================================================================
-//  main
+//  Adaptive mode: start-up calibration and run-time threshold control
 // ===========================================================================
-int main(int argc, char *argv[])
+//  Pinning pages and handling completions costs a roughly fixed amount
+//  per send, while the copy it saves grows with the send size, so below
+//  some size a plain copy wins.  a3_calibrate() finds that size on this
+//  machine: it sends CAL_BYTES at each size from CAL_MIN_SIZE to
+//  CAL_MAX_SIZE over a loopback connection, once copied and once with
+//  MSG_ZEROCOPY, and picks the smallest size from which zero-copy is
+//  never slower.  Loopback matches the veth setup of the experiments;
+//  over a real NIC pass an explicit --adaptive BYTES instead.
+// ---------------------------------------------------------------------------
+#define CAL_MIN_SIZE  1024
+#define CAL_MAX_SIZE  (256 * 1024)
+#define CAL_BYTES     (16 * 1024 * 1024)  /* Sent per size and path         */
+#define CAL_SIZES     9                   /* 1 KB, 2 KB, ... 256 KB         */
+
+// ---------------------------------------------------------------------------
+//  cal_sink — receiver thread: reads and discards until EOF.
+// ---------------------------------------------------------------------------
+static void *cal_sink(void *arg)
 {
-    /* ---- Parse command-line arguments --------------------------------- */
-    if (argc != 3) {
-        fprintf(stderr, "Usage: %s <port> <message_size_bytes>\n", argv[0]);
-        return EXIT_FAILURE;
+    int   fd  = *(int *)arg;
+    char *buf = (char *)malloc(CAL_MAX_SIZE);
+    if (buf != NULL) {
+        while (recv(fd, buf, CAL_MAX_SIZE, 0) > 0) {
+        }
+        free(buf);
     }
+    return NULL;
+}
 
-    int    port     = atoi(argv[1]);
-    size_t msg_size = (size_t)atol(argv[2]);
+// ---------------------------------------------------------------------------
+//  cal_run — sends CAL_BYTES in `size`-byte sends; returns the wall time
+//  in µs (including the wait for every zero-copy completion), or -1.
+// ---------------------------------------------------------------------------
+static double cal_run(int fd, const char *buf, size_t size, bool zc,
+                      size_t drain_at)
+{
+    size_t pending = 0;
+    double t0      = get_time_us();
 
-    if (port <= 0 || port > 65535) {
-        fprintf(stderr, "[Server-A3] Invalid port: %d\n", port);
-        return EXIT_FAILURE;
+    for (size_t sent = 0; sent < CAL_BYTES; ) {
+        ssize_t n = send(fd, buf, size, zc ? MSG_ZEROCOPY : 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS && pending > 0) {
+                struct pollfd pfd = { .fd = fd, .events = 0 };
+                poll(&pfd, 1, ZC_WAIT_MS);
+                drain_completions(fd, &pending, NULL, NULL);
+                continue;
+            }
+            perror("[Server-A3] calibration send");
+            return -1.0;
+        }
+        sent += (size_t)n;
+        if (zc && ++pending >= drain_at) {
+            drain_completions(fd, &pending, NULL, NULL);
+        }
     }
-    if (msg_size == 0) {
-        fprintf(stderr, "[Server-A3] Message size must be > 0\n");
-        return EXIT_FAILURE;
+
+    while (pending > 0) {
+        struct pollfd pfd = { .fd = fd, .events = 0 };
+        if (poll(&pfd, 1, ZC_CLOSE_TIMEOUT_MS) <= 0) {
+            break;
+        }
+        drain_completions(fd, &pending, NULL, NULL);
     }
+    return get_time_us() - t0;
+}
 
-    printf("[Server-A3] Zero-Copy (sendmsg + MSG_ZEROCOPY)\n");
-    printf("[Server-A3] Port: %d | Message size: %zu bytes\n", port, msg_size);
+// ---------------------------------------------------------------------------
+//  a3_calibrate
+//  ------------
+//  Returns the measured threshold (ZC_THRESHOLD_MAX if zero-copy never
+//  won), or 0 if the benchmark could not be run.
+// ---------------------------------------------------------------------------
+static size_t a3_calibrate(void)
+{
+    int lfd = socket(AF_INET, SOCK_STREAM, 0);
+    int sfd = socket(AF_INET, SOCK_STREAM, 0);
+    int rfd = -1;
+    struct sockaddr_in addr;
+    socklen_t          len = sizeof(addr);
 
-    /* ---- Install SIGINT handler --------------------------------------- */
-    struct sigaction sa;
-    memset(&sa, 0, sizeof(sa));
-    sa.sa_handler = sigint_handler;
-    sigemptyset(&sa.sa_mask);
-    sa.sa_flags = 0;
-    if (sigaction(SIGINT, &sa, NULL) < 0) {
-        perror("[Server-A3] sigaction");
-        return EXIT_FAILURE;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int zc_flag = 1;
+    if (lfd < 0 || sfd < 0 ||
+        bind(lfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        listen(lfd, 1) < 0 ||
+        getsockname(lfd, (struct sockaddr *)&addr, &len) < 0 ||
+        connect(sfd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+        (rfd = accept(lfd, NULL, NULL)) < 0 ||
+        setsockopt(sfd, SOL_SOCKET, SO_ZEROCOPY,
+                   &zc_flag, sizeof(zc_flag)) < 0) {
+        perror("[Server-A3] calibration setup");
+        if (lfd >= 0) close(lfd);
+        if (sfd >= 0) close(sfd);
+        if (rfd >= 0) close(rfd);
+        return 0;
     }
-    signal(SIGPIPE, SIG_IGN);
+    close(lfd);
 
-    /* ---- Create listening socket -------------------------------------- */
-    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
-    if (listen_fd < 0) {
-        perror("[Server-A3] socket");
-        return EXIT_FAILURE;
+    pthread_t sink;
+    if (pthread_create(&sink, NULL, cal_sink, &rfd) != 0) {
+        fprintf(stderr, "[Server-A3] calibration: pthread_create failed\n");
+        close(sfd);
+        close(rfd);
+        return 0;
     }
 
-    int opt = 1;
-    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
-        perror("[Server-A3] setsockopt SO_REUSEADDR");
-        close(listen_fd);
-        return EXIT_FAILURE;
+    char *buf = NULL;
+    if (posix_memalign((void **)&buf, (size_t)sysconf(_SC_PAGESIZE),
+                       CAL_MAX_SIZE) != 0) {
+        buf = NULL;
+    } else {
+        memset(buf, 'C', CAL_MAX_SIZE);
     }
 
-    /* ---- Bind --------------------------------------------------------- */
-    struct sockaddr_in serv_addr;
-    memset(&serv_addr, 0, sizeof(serv_addr));
-    serv_addr.sin_family      = AF_INET;
-    serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
-    serv_addr.sin_port        = htons((uint16_t)port);
+    size_t drain_at  = zc_drain_threshold();
+    size_t threshold = ZC_THRESHOLD_MAX;
+    bool   ok        = (buf != NULL);
 
-    if (bind(listen_fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
-        perror("[Server-A3] bind");
-        close(listen_fd);
-        return EXIT_FAILURE;
-    }
+    printf("[Server-A3] Calibrating copy vs MSG_ZEROCOPY (%d MB per point)\n",
+           CAL_BYTES >> 20);
 
-    /* ---- Listen ------------------------------------------------------- */
-    if (listen(listen_fd, BACKLOG) < 0) {
-        perror("[Server-A3] listen");
-        close(listen_fd);
-        return EXIT_FAILURE;
+    /*
+     * Walk sizes downwards; the threshold is the smallest size from
+     * which zero-copy won at every size measured.
+     */
+    bool zc_wins = true;
+    for (int i = CAL_SIZES - 1; ok && i >= 0; i--) {
+        size_t size    = (size_t)CAL_MIN_SIZE << i;
+        double copy_us = cal_run(sfd, buf, size, false, drain_at);
+        double zc_us   = cal_run(sfd, buf, size, true,  drain_at);
+        if (copy_us < 0.0 || zc_us < 0.0) {
+            ok = false;
+            break;
+        }
+
+        printf("[Server-A3]   %7zu B: copy %7.2f Gbps, zero-copy %7.2f Gbps\n",
+               size, CAL_BYTES * 8.0 / (copy_us * 1e3),
+               CAL_BYTES * 8.0 / (zc_us * 1e3));
+
+        zc_wins = zc_wins && (zc_us <= copy_us);
+        if (zc_wins) {
+            threshold = size;
+        }
     }
 
-    printf("[Server-A3] Listening on port %d … (Ctrl+C to stop)\n", port);
+    shutdown(sfd, SHUT_WR);
+    pthread_join(sink, NULL);
+    close(sfd);
+    close(rfd);
+    free(buf);
 
-    /* ---- Accept loop -------------------------------------------------- */
-    while (g_running) {
-        struct sockaddr_in client_addr;
-        socklen_t addr_len = sizeof(client_addr);
+    return ok ? threshold : 0;
+}
 
-        int client_fd = accept(listen_fd,
-                               (struct sockaddr *)&client_addr,
-                               &addr_len);
+// ---------------------------------------------------------------------------
+//  a3_threshold_signal
+//  -------------------
+//  SIGUSR1 halves the zero-copy threshold (more sends go zero-copy),
+//  SIGUSR2 doubles it.  Only async-signal-safe calls: the new value is
+//  formatted by hand and written with write(2).
+// ---------------------------------------------------------------------------
+static void a3_threshold_signal(int signo)
+{
+    size_t t = __atomic_load_n(&g_zc_threshold, __ATOMIC_RELAXED);
+    if (signo == SIGUSR1) {
+        t = (t > 1) ? t / 2 : 1;
+    } else {
+        t = (t < ZC_THRESHOLD_MAX / 2) ? t * 2 : ZC_THRESHOLD_MAX;
+    }
+    __atomic_store_n(&g_zc_threshold, t, __ATOMIC_RELAXED);
 
-        if (client_fd < 0) {
-            if (errno == EINTR) {
-                continue;
-            }
-            perror("[Server-A3] accept");
-            continue;
-        }
+    static const char prefix[] = "[Server-A3] zero-copy threshold now ";
+    char   line[sizeof(prefix) + 32];
+    char   digits[24];
+    size_t n = 0, d = 0;
 
-        printf("[Server-A3] Accepted connection from %s:%d (fd=%d)\n",
-               inet_ntoa(client_addr.sin_addr),
-               ntohs(client_addr.sin_port),
-               client_fd);
+    memcpy(line, prefix, sizeof(prefix) - 1);
+    n = sizeof(prefix) - 1;
+    do {
+        digits[d++] = (char)('0' + t % 10);
+        t /= 10;
+    } while (t > 0);
+    while (d > 0) {
+        line[n++] = digits[--d];
+    }
+    memcpy(line + n, " bytes\n", 7);
+    n += 7;
 
-        /* Disable Nagle */
-        int flag = 1;
-        setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    ssize_t w = write(STDOUT_FILENO, line, n);
+    (void)w;
+}
 
-        /* Heap-allocate thread args */
-        thread_args_t *targs = (thread_args_t *)malloc(sizeof(thread_args_t));
-        if (targs == NULL) {
-            perror("[Server-A3] malloc thread_args");
-            close(client_fd);
-            continue;
+// ===========================================================================
+//  a3_init
+// ===========================================================================
+//  Splits the --profile layout into send runs and, in adaptive mode,
+//  calibrates the threshold (--adaptive auto) and installs the SIGUSR1 /
+//  SIGUSR2 handlers that adjust it while serving.
+// ---------------------------------------------------------------------------
+static int a3_init(const server_opts_t *opts)
+{
+    g_runs = (a3_run_t *)calloc((size_t)opts->layout.n_fields,
+                                sizeof(a3_run_t));
+    if (g_runs == NULL) {
+        perror("[Server-A3] malloc runs");
+        return -1;
+    }
+    g_n_runs = a3_build_runs(&opts->layout, g_runs);
+
+    if (g_hybrid > 0) {
+        printf("[Server-A3] %d send run(s):", g_n_runs);
+        for (int r = 0; r < g_n_runs; r++) {
+            printf(" %zu B %s", g_runs[r].len, g_runs[r].zc ? "zc" : "copy");
         }
-        targs->sock_fd      = client_fd;
-        targs->msg_size     = msg_size;
-        targs->duration_sec = 0;
+        printf("\n");
+    }
 
-        pthread_t tid;
-        if (pthread_create(&tid, NULL, client_handler, targs) != 0) {
-            perror("[Server-A3] pthread_create");
-            free(targs);
-            close(client_fd);
-            continue;
+    if (!g_adaptive) {
+        return 0;
+    }
+
+    if (g_calibrate) {
+        size_t t = a3_calibrate();
+        if (t == 0) {
+            fprintf(stderr, "[Server-A3] Calibration failed\n");
+            return -1;
         }
-        pthread_detach(tid);
+        __atomic_store_n(&g_zc_threshold, t, __ATOMIC_RELAXED);
     }
 
-    /* ---- Shutdown ----------------------------------------------------- */
-    printf("\n[Server-A3] Shutting down …\n");
-    close(listen_fd);
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = a3_threshold_signal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGUSR1, &sa, NULL) < 0 ||
+        sigaction(SIGUSR2, &sa, NULL) < 0) {
+        perror("[Server-A3] sigaction SIGUSR1/SIGUSR2");
+        return -1;
+    }
 
-    return EXIT_SUCCESS;
+    size_t t = __atomic_load_n(&g_zc_threshold, __ATOMIC_RELAXED);
+    if (t >= ZC_THRESHOLD_MAX) {
+        printf("[Server-A3] Adaptive: zero-copy never faster — copying "
+               "(SIGUSR1 lowers the threshold)\n");
+    } else {
+        printf("[Server-A3] Adaptive: MSG_ZEROCOPY for sends >= %zu bytes "
+               "(SIGUSR1 halves, SIGUSR2 doubles)\n", t);
+    }
+    return 0;
+}
+
+static const conn_ops_t a3_ops = {
+    .tag         = "[Server-A3]",
+    .banner      = "Zero-Copy (sendmsg + MSG_ZEROCOPY)",
+    .open        = a3_open,
+    .step        = a3_step,
+    .on_error    = a3_on_error,
+    .close       = a3_close,
+    .extra_opts  = a3_long_opts,
+    .extra_short = "k:f:a:y:",
+    .extra_usage = "  -k, --ring K              rotate K messages, each reused "
+                   "only after its\n"
+                   "                            zero-copy completion "
+                   "(default: 1 static message)\n"
+                   "  -f, --fallback R          switch to plain sendmsg() "
+                   "once a fraction R\n"
+                   "                            of completions report "
+                   "ZEROCOPY_COPIED\n"
+                   "  -a, --adaptive auto|BYTES MSG_ZEROCOPY only for sends "
+                   "of at least BYTES,\n"
+                   "                            copy below (auto = calibrate "
+                   "at start-up)\n"
+                   "  -y, --hybrid BYTES        copy fields below BYTES "
+                   "(coalesced with MSG_MORE),\n"
+                   "                            zero-copy the larger ones\n",
+    .parse_opt   = a3_parse_opt,
+    .init        = a3_init,
+};
+
+// ===========================================================================
+//  main
+// ===========================================================================
+int main(int argc, char *argv[])
+{
+    return server_main(argc, argv, &a3_ops);
 }
@@ -0,0 +1,44 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_Part_A4_Client.c
+// Purpose: io_uring Batched TCP Client (paired with the A4 server)
+//
+//          Companion client for the A4 io_uring server.  The receive path
+//          is the same recv() loop as the A1–A3 clients:
+//
+//            • io_uring batching is a SEND-side optimisation.  The server
+//              hands qd sendmsg() operations to the kernel per system call,
+//              but the resulting TCP byte stream is indistinguishable from
+//              the A2 server's.
+//
+//            • On the RECEIVE side, recv() still performs one kernel→user
+//              copy per call, so any difference between A2 and A4 runs is
+//              attributable to the server's system-call count.
+//
+// Usage:
+//   ./MT25082_Part_A4_Client [options]
+//       <server_ip> <port> <msg_size> <threads> <duration>
+//
+//   The options (--recv engine, --ring, --spin, --busy-poll, --nfields,
+//   --profile, --pool, --mlock, --numa, --cpus, --rt) are shared by every
+//   client and listed in MT25082_client.h.
+//
+// Example:
+//   ./MT25082_Part_A4_Client 10.0.0.1 9093 64 4 10
+// =============================================================================
+
+#include "MT25082_client.h"
+
+static const client_info_t a4_info = {
+    .tag     = "[Client-A4]",
+    .banner  = "io_uring Client (paired with batched SENDMSG server)",
+    .summary = "A4 — io_uring",
+};
+
+// ===========================================================================
+//  main
+// ===========================================================================
+int main(int argc, char *argv[])
+{
+    return client_main(argc, argv, &a4_info);
+}
@@ -0,0 +1,831 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_Part_A4_Server.c
+// Purpose: Batched TCP Server using io_uring (IORING_OP_SENDMSG)
+//
+//          This server sends exactly the same message_t / 8-entry iovec as
+//          the A2 server, but instead of one sendmsg() system call per
+//          message it queues a batch of IORING_OP_SENDMSG submission-queue
+//          entries (SQEs) and hands the whole batch to the kernel with ONE
+//          io_uring_enter() call, which also waits for the batch's
+//          completion-queue entries (CQEs).
+//
+// Batched Submission Path:
+// ========================
+//
+//   User Space                      Kernel Space                  Hardware
+//  +-------------+                 +------------------+          +--------+
+//  | SQE 0  ─┐   |                 |                  |          |        |
+//  | SQE 1  ─┤ link                | sendmsg(iov) x qd| -------> |  NIC   |
+//  | ...     │   | io_uring_enter  | (same copy as A2)|   DMA    | TX ring|
+//  | SQE qd-1┘   | ──────────────> |                  |          |        |
+//  +-------------+  (1 syscall)    +------------------+          +--------+
+//  | CQE x qd    | <────────────── results posted to CQ ring (no syscall
+//  +-------------+                 needed to read them)
+//
+//   • Data movement is identical to A2 (one consolidated user→kernel copy
+//     per message); only the number of user↔kernel transitions changes:
+//       A2: 1 syscall per message      A4: 1 syscall per qd messages
+//   • The SQEs of one batch are chained with IOSQE_IO_LINK so the kernel
+//     executes them strictly in order — several sends outstanding on one
+//     TCP socket must never interleave their bytes.  MSG_WAITALL makes the
+//     kernel retry short sends internally, so every CQE normally reports
+//     a complete message.
+//   • Comparing A4 with A2 at 64 B / 256 B isolates how much of the
+//     small-message cost is system-call overhead.
+//
+// Zero-Copy Variants (--zc):
+// ==========================
+//
+//   --zc fixed   The message's iovec entries (one per field, or fewer
+//                when a single-block --alloc merges adjacent fields) are
+//                registered with the ring ONCE (IORING_REGISTER_BUFFERS),
+//                so their pages are pinned and mapped at startup.  Each
+//                entry is then sent with its own IORING_OP_SEND_ZC SQE
+//                carrying IORING_RECVSEND_FIXED_BUF / buf_index = entry —
+//                no per-send page pinning at all.
+//   --zc msg     One IORING_OP_SENDMSG_ZC SQE per message over the normal
+//                iovec; pages are pinned per send exactly as in A3.
+//
+//   In both variants the "buffer released" notification that A3 fetches
+//   with recvmsg(MSG_ERRQUEUE) arrives as a second CQE instead:
+//
+//     SQE ──> CQE{res = bytes, flags = F_MORE}      (send finished)
+//         ──> CQE{flags = F_NOTIF}                  (NIC done with pages)
+//
+//   so completions are reaped from the CQ ring with no extra system call.
+//   IORING_SEND_ZC_REPORT_USAGE additionally flags notifications whose data
+//   had to be copied after all (e.g. loopback), mirroring A3's
+//   SO_EE_CODE_ZEROCOPY_COPIED.
+//
+// Kernel-Polled Submission (--sqpoll CPU):
+// ========================================
+//
+//   Every connection ring is created with IORING_SETUP_SQPOLL and attached
+//   (IORING_SETUP_ATTACH_WQ) to ONE shared kernel polling thread pinned to
+//   CPU.  The socket is a registered file (IOSQE_FIXED_FILE), so the poller
+//   skips the fd lookup too.  The sender thread then only writes SQEs and
+//   busy-polls the CQ ring: in steady state it makes no system call at all
+//   — io_uring_enter() is needed only to wake a poller that went idle.
+//   The price is CPU: the poller and every sender spin, which the server
+//   reports (sender thread and poller CPU time) next to the syscall count.
+//
+// Usage:
+//   ./MT25082_Part_A4_Server [--qd N] [--zc fixed|msg] [--sqpoll CPU]
+//                            <port> <msg_size>
+//
+// Prerequisites:
+//   • Linux kernel ≥ 5.6 (IORING_OP_SENDMSG) — ≥ 5.18 recommended so that
+//     MSG_WAITALL is honoured for stream sockets.
+//   • --zc needs ≥ 6.0 (SEND_ZC), ≥ 6.1 for msg (SENDMSG_ZC) and ≥ 6.2 for
+//     the copied-vs-zero-copy usage report.  Older kernels reject the
+//     IORING_SEND_ZC_REPORT_USAGE bit with EINVAL, so a4_init() probes for
+//     it once and leaves it off (and the report out) where it is unknown.
+//   • --sqpoll needs ≥ 5.11 to run without CAP_SYS_NICE.
+// =============================================================================
+
+#include "MT25082_server.h"
+#include "MT25082_uring.h"
+
+#include <dirent.h>             /* opendir (locating the SQ poller thread)   */
+
+#define DEFAULT_QUEUE_DEPTH 8   /* Outstanding messages per connection batch */
+#define DRAIN_TIMEOUT_MS    1000 /* Bound on waiting for in-flight SQEs and
+                                    zero-copy notifications at close        */
+#define SQPOLL_IDLE_MS      1000 /* Poller spins this long before sleeping    */
+
+// ---------------------------------------------------------------------------
+//  a4_zc_mode_t
+// ---------------------------------------------------------------------------
+typedef enum {
+    A4_ZC_NONE = 0,             /* IORING_OP_SENDMSG (copying, like A2)      */
+    A4_ZC_FIXED,                /* IORING_OP_SEND_ZC per registered buffer   */
+    A4_ZC_MSG                   /* IORING_OP_SENDMSG_ZC over the iovec       */
+} a4_zc_mode_t;
+
+static const char *const a4_zc_names[] = { "off", "fixed", "msg" };
+
+// ---------------------------------------------------------------------------
+//  Server-specific options
+// ---------------------------------------------------------------------------
+static unsigned     g_queue_depth = DEFAULT_QUEUE_DEPTH;
+static a4_zc_mode_t g_zc_mode     = A4_ZC_NONE;
+static bool         g_sqpoll      = false;
+static int          g_sqpoll_cpu  = -1;
+static bool         g_zc_usage    = false;  /* REPORT_USAGE accepted (≥ 6.2)*/
+
+static const struct option a4_long_opts[] = {
+    { "qd",     required_argument, NULL, 'q' },
+    { "zc",     required_argument, NULL, 'z' },
+    { "sqpoll", required_argument, NULL, 's' },
+    { NULL, 0,                     NULL,  0  }
+};
+
+// ---------------------------------------------------------------------------
+//  Shared SQ polling thread
+// ---------------------------------------------------------------------------
+//  The first SQPOLL ring owns the kernel poller; every later connection
+//  ring attaches to it.  The anchor ring lives until the process exits so
+//  the poller survives the connection that happened to create it.
+// ---------------------------------------------------------------------------
+static pthread_mutex_t g_sq_anchor_lock = PTHREAD_MUTEX_INITIALIZER;
+static int             g_sq_anchor_fd   = -1;
+
+static int a4_parse_opt(int c, const char *arg)
+{
+    switch (c) {
+    case 'q':
+        g_queue_depth = (unsigned)atoi(arg);
+        if (g_queue_depth == 0 || g_queue_depth > 4096) {
+            fprintf(stderr, "[Server-A4] Queue depth must be 1..4096\n");
+            return -1;
+        }
+        return 0;
+    case 'z':
+        if (strcmp(arg, "fixed") == 0) {
+            g_zc_mode = A4_ZC_FIXED;
+        } else if (strcmp(arg, "msg") == 0) {
+            g_zc_mode = A4_ZC_MSG;
+        } else {
+            fprintf(stderr, "[Server-A4] Unknown --zc mode '%s' "
+                    "(expected fixed or msg)\n", arg);
+            return -1;
+        }
+        return 0;
+    case 's':
+        if (strcmp(arg, "any") == 0) {
+            g_sqpoll_cpu = -1;
+        } else {
+            g_sqpoll_cpu = atoi(arg);
+            if (g_sqpoll_cpu < 0 || g_sqpoll_cpu >= MAX_CPUS) {
+                fprintf(stderr, "[Server-A4] --sqpoll CPU must be 0..%d "
+                        "or 'any'\n", MAX_CPUS - 1);
+                return -1;
+            }
+        }
+        g_sqpoll = true;
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+// ===========================================================================
+//  a4_probe_send_zc
+// ===========================================================================
+//  Submits one SEND_ZC with `ioprio` on an unconnected TCP socket and
+//  returns its result.  Prep validates the opcode and the ioprio bits
+//  before the socket is looked at, so -EINVAL means "not supported" and
+//  anything else (here -EPIPE / -ENOTCONN) means the SQE was accepted.
+// ---------------------------------------------------------------------------
+static int a4_probe_send_zc(uring_t *r, int fd, unsigned short ioprio)
+{
+    static char byte;
+
+    struct io_uring_sqe *sqe = uring_get_sqe(r);
+    sqe->opcode    = IORING_OP_SEND_ZC;
+    sqe->fd        = fd;
+    sqe->addr      = (unsigned long)&byte;
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->ioprio    = ioprio;
+    if (uring_submit(r, 1) < 0) {
+        return -errno;
+    }
+
+    /* The send CQE; a notification, if any, may come first */
+    for (;;) {
+        struct io_uring_cqe *cqe = uring_peek_cqe(r);
+        if (cqe == NULL) {
+            if (uring_submit(r, 1) < 0) {
+                return -errno;
+            }
+            continue;
+        }
+        bool notif = (cqe->flags & IORING_CQE_F_NOTIF) != 0;
+        int  res   = cqe->res;
+        uring_cqe_seen(r);
+        if (!notif) {
+            return res;
+        }
+    }
+}
+
+// ===========================================================================
+//  a4_init
+// ===========================================================================
+//  With --zc, checks once that the kernel knows SEND_ZC at all (≥ 6.0)
+//  and whether it accepts IORING_SEND_ZC_REPORT_USAGE (≥ 6.2).
+// ---------------------------------------------------------------------------
+static int a4_init(const server_opts_t *opts)
+{
+    (void)opts;
+
+    if (g_zc_mode == A4_ZC_NONE) {
+        return 0;
+    }
+
+    uring_t r;
+    int     fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0 || uring_init(&r, 2) < 0) {
+        perror("[Server-A4] --zc probe");
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+
+    int rc = 0;
+    if (a4_probe_send_zc(&r, fd, IORING_SEND_ZC_REPORT_USAGE) != -EINVAL) {
+        g_zc_usage = true;
+    } else if (a4_probe_send_zc(&r, fd, 0) == -EINVAL) {
+        fprintf(stderr, "[Server-A4] --zc needs IORING_OP_SEND_ZC "
+                "(Linux 6.0)\n");
+        rc = -1;
+    } else {
+        printf("[Server-A4] IORING_SEND_ZC_REPORT_USAGE unsupported "
+               "(Linux < 6.2): no zero-copy / copied breakdown\n");
+    }
+
+    uring_exit(&r);
+    close(fd);
+    return rc;
+}
+
+// ===========================================================================
+//  a4_conn_t
+// ===========================================================================
+//  Per-connection state: one private io_uring, the pre-registered iovec /
+//  msghdr shared (read-only) by every SQE, and a second msghdr used for the
+//  tail of a message that a failed link left partially sent.
+//
+//  In the zero-copy variants every queued SQE owes exactly one notification
+//  CQE — even when a broken link cancels it, the kernel still flushes the
+//  notification it set up at prep time.  a4_close() waits until the two
+//  counts match so it never frees buffers the NIC may still be reading.
+// ---------------------------------------------------------------------------
+typedef struct {
+    int           fd;                   /* Connected socket                  */
+    size_t        msg_size;             /* Total message size (bytes)        */
+    unsigned      qd;                   /* Messages submitted per batch      */
+    a4_zc_mode_t  zc;                   /* Send opcode variant               */
+    uring_t       ring;                 /* Private submission/completion ring*/
+    message_t     msg;                  /* Private heap-allocated message    */
+    int           n_iov;                /* iovec entries per message         */
+    struct iovec *iov;                  /* Pre-registered scatter array      */
+    struct msghdr mh;                   /* Shared by all full-message SQEs   */
+    struct iovec *tail_iov;             /* Unsent part of a partial message  */
+    struct msghdr tail_mh;
+    size_t        msg_off;              /* Bytes of current message sent     */
+    unsigned      inflight;             /* Submitted SQEs without a CQE      */
+    bool          failed;               /* A CQE reported a fatal error      */
+    size_t        batches;              /* Batches submitted                 */
+    size_t        zc_sqes;              /* ZC SQEs queued (one notif each)   */
+    size_t        notifs_zc;            /* Notifications: truly zero-copy    */
+    size_t        notifs_copied;        /* Notifications: kernel copied      */
+    bool          fixed_file;           /* Socket is registered file 0       */
+    double        start_cpu;            /* Sender thread CPU seconds at open */
+    size_t        total_bytes_sent;
+    size_t        total_messages;
+    double        start_time;
+} a4_conn_t;
+
+// ===========================================================================
+//  a4_init_sqpoll_ring
+// ===========================================================================
+//  Creates an SQPOLL ring, attached to the shared poller once one exists.
+// ---------------------------------------------------------------------------
+static int a4_init_sqpoll_ring(uring_t *ring, unsigned entries)
+{
+    pthread_mutex_lock(&g_sq_anchor_lock);
+
+    if (g_sq_anchor_fd < 0) {
+        static uring_t anchor;
+        if (uring_init_sqpoll(&anchor, 1, g_sqpoll_cpu, SQPOLL_IDLE_MS,
+                              -1) < 0) {
+            pthread_mutex_unlock(&g_sq_anchor_lock);
+            return -1;
+        }
+        g_sq_anchor_fd = anchor.ring_fd;
+    }
+
+    int rc = uring_init_sqpoll(ring, entries, g_sqpoll_cpu, SQPOLL_IDLE_MS,
+                               g_sq_anchor_fd);
+    pthread_mutex_unlock(&g_sq_anchor_lock);
+    return rc;
+}
+
+// ===========================================================================
+//  a4_sqpoll_cpu_s
+// ===========================================================================
+//  CPU seconds consumed so far by the kernel SQ poller, which shows up as
+//  an "iou-sqp-<pid>" thread of this process.  Returns -1 if not found.
+// ---------------------------------------------------------------------------
+static double a4_sqpoll_cpu_s(void)
+{
+    DIR *dir = opendir("/proc/self/task");
+    if (dir == NULL) {
+        return -1.0;
+    }
+
+    double         total = -1.0;
+    struct dirent *de;
+    while ((de = readdir(dir)) != NULL) {
+        if (de->d_name[0] == '.') {
+            continue;
+        }
+
+        char path[320];
+        char buf[512];
+        snprintf(path, sizeof(path), "/proc/self/task/%s/stat", de->d_name);
+        FILE *f = fopen(path, "r");
+        if (f == NULL) {
+            continue;
+        }
+        size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+        fclose(f);
+        buf[n] = '\0';
+
+        /* stat: "tid (comm) state ... utime(14) stime(15) ..." */
+        char *comm = strchr(buf, '(');
+        char *rest = strrchr(buf, ')');
+        if (comm == NULL || rest == NULL || strncmp(comm + 1, "iou-sqp", 7)) {
+            continue;
+        }
+
+        unsigned long utime = 0, stime = 0;
+        if (sscanf(rest + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u "
+                   "%lu %lu", &utime, &stime) == 2) {
+            total = ((total < 0.0) ? 0.0 : total) +
+                    (double)(utime + stime) / (double)sysconf(_SC_CLK_TCK);
+        }
+    }
+    closedir(dir);
+    return total;
+}
+
+// ===========================================================================
+//  a4_open
+// ===========================================================================
+static void *a4_open(int fd, const server_opts_t *opts, bool nonblocking)
+{
+    (void)nonblocking;  /* thread_only: always a blocking socket */
+
+    printf("[Server-A4] Thread %lu: handling client fd=%d, msg_size=%zu, "
+           "qd=%u, zc=%s\n", (unsigned long)pthread_self(), fd,
+           opts->msg_size, g_queue_depth, a4_zc_names[g_zc_mode]);
+
+    a4_conn_t *c = (a4_conn_t *)calloc(1, sizeof(a4_conn_t));
+    if (c == NULL) {
+        perror("[Server-A4] malloc conn");
+        return NULL;
+    }
+
+    c->fd       = fd;
+    c->msg_size = opts->msg_size;
+    c->qd       = g_queue_depth;
+    c->zc       = g_zc_mode;
+
+    c->ring.ring_fd = -1;       /* Nothing for uring_exit() to release yet */
+
+    /* ---- Allocate message on the heap (per-connection, private) ------- */
+    const msg_layout_t *layout = &opts->layout;
+    allocate_message_as(&c->msg, layout, opts->alloc);
+    fill_message(&c->msg, layout);
+    c->iov      = (struct iovec *)calloc((size_t)layout->n_fields,
+                                         sizeof(struct iovec));
+    c->tail_iov = (struct iovec *)calloc((size_t)layout->n_fields,
+                                         sizeof(struct iovec));
+    if (c->msg.field == NULL || c->iov == NULL || c->tail_iov == NULL) {
+        perror("[Server-A4] malloc message");
+        goto fail;
+    }
+
+    /* ---- Pre-register iovec (same layout as A2) ----------------------- */
+    c->n_iov = message_iov(&c->msg, layout, 0, layout->n_fields, c->iov);
+
+    /* The fixed-buffer variant spends one SQE per iovec entry */
+    unsigned sqes_per_msg = (c->zc == A4_ZC_FIXED) ? (unsigned)c->n_iov : 1;
+
+    int rc = g_sqpoll ? a4_init_sqpoll_ring(&c->ring, c->qd * sqes_per_msg)
+                      : uring_init(&c->ring, c->qd * sqes_per_msg);
+    if (rc < 0) {
+        perror("[Server-A4] io_uring_setup");
+        goto fail;
+    }
+
+    /*
+     * With SQPOLL the socket is also registered so that the poller uses
+     * the ring's file table instead of looking the fd up per request.
+     */
+    if (g_sqpoll) {
+        if (uring_register_files(&c->ring, &c->fd, 1) < 0) {
+            perror("[Server-A4] io_uring_register(FILES)");
+            goto fail;
+        }
+        c->fixed_file = true;
+    }
+
+    /*
+     * The kernel only reads the msghdr, and the content never changes, so
+     * one msghdr safely backs every outstanding full-message SQE.
+     */
+    memset(&c->mh, 0, sizeof(c->mh));
+    c->mh.msg_iov    = c->iov;
+    c->mh.msg_iovlen = (size_t)c->n_iov;
+
+    memset(&c->tail_mh, 0, sizeof(c->tail_mh));
+    c->tail_mh.msg_iov = c->tail_iov;
+
+    /*
+     * Register the iovec entries once as fixed buffers: the kernel pins
+     * their pages now instead of on every send.  message_iov() leaves no
+     * empty entries, so each one can be registered as it is.
+     */
+    if (c->zc == A4_ZC_FIXED) {
+        if (uring_register_buffers(&c->ring, c->iov, (unsigned)c->n_iov) < 0) {
+            perror("[Server-A4] io_uring_register(BUFFERS)");
+            goto fail;
+        }
+    }
+
+    c->start_cpu  = get_thread_cpu_s();
+    c->start_time = get_time_us();
+    return c;
+
+fail:
+    uring_exit(&c->ring);
+    free_message(&c->msg);
+    free(c->iov);
+    free(c->tail_iov);
+    free(c);
+    return NULL;
+}
+
+// ===========================================================================
+//  a4_prep_sendmsg
+// ===========================================================================
+//  Fills one IORING_OP_SENDMSG (or SENDMSG_ZC) SQE.
+// ---------------------------------------------------------------------------
+static void a4_prep_sendmsg(struct io_uring_sqe *sqe, int fd,
+                            const struct msghdr *mh, bool zerocopy)
+{
+    sqe->opcode    = zerocopy ? IORING_OP_SENDMSG_ZC : IORING_OP_SENDMSG;
+    sqe->fd        = fd;
+    sqe->addr      = (unsigned long)mh;
+    sqe->len       = 1;
+    sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+    sqe->flags     = IOSQE_IO_LINK;
+    if (zerocopy && g_zc_usage) {
+        sqe->ioprio = IORING_SEND_ZC_REPORT_USAGE;
+    }
+}
+
+// ===========================================================================
+//  a4_prep_send_fixed
+// ===========================================================================
+//  Fills one IORING_OP_SEND_ZC SQE for (part of) registered buffer `index`.
+// ---------------------------------------------------------------------------
+static void a4_prep_send_fixed(struct io_uring_sqe *sqe, int fd,
+                               const struct iovec *part, unsigned index)
+{
+    sqe->opcode    = IORING_OP_SEND_ZC;
+    sqe->fd        = fd;
+    sqe->addr      = (unsigned long)part->iov_base;
+    sqe->len       = (unsigned)part->iov_len;
+    sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL;
+    sqe->ioprio    = IORING_RECVSEND_FIXED_BUF |
+                     (g_zc_usage ? IORING_SEND_ZC_REPORT_USAGE : 0);
+    sqe->buf_index = (unsigned short)index;
+    sqe->flags     = IOSQE_IO_LINK;
+}
+
+// ===========================================================================
+//  a4_target
+// ===========================================================================
+//  Points a prepared SQE at the socket: registered file 0 or the raw fd.
+// ---------------------------------------------------------------------------
+static void a4_target(const a4_conn_t *c, struct io_uring_sqe *sqe)
+{
+    if (c->fixed_file) {
+        sqe->fd     = 0;
+        sqe->flags |= IOSQE_FIXED_FILE;
+    }
+}
+
+// ===========================================================================
+//  a4_queue_message
+// ===========================================================================
+//  Queues the SQE(s) for the rest of the current message, starting `off`
+//  bytes in.  Returns the last SQE queued, or NULL if the ring was full.
+// ---------------------------------------------------------------------------
+static struct io_uring_sqe *a4_queue_message(a4_conn_t *c, size_t off)
+{
+    struct io_uring_sqe *sqe  = NULL;
+    const struct iovec  *iov  = c->iov;
+    int                  iovcnt = c->n_iov;
+    const struct msghdr *mh   = &c->mh;
+
+    if (off > 0) {
+        iovcnt = iov_tail(c->iov, c->n_iov, off, c->tail_iov);
+        iov    = c->tail_iov;
+        c->tail_mh.msg_iovlen = (size_t)iovcnt;
+        mh     = &c->tail_mh;
+    }
+
+    if (c->zc != A4_ZC_FIXED) {
+        sqe = uring_get_sqe(&c->ring);
+        if (sqe != NULL) {
+            a4_prep_sendmsg(sqe, c->fd, mh, c->zc == A4_ZC_MSG);
+            a4_target(c, sqe);
+            c->inflight++;
+            c->zc_sqes += (c->zc == A4_ZC_MSG);
+        }
+        return sqe;
+    }
+
+    /* iov_tail() keeps the trailing entries, so entry j is buffer first+j */
+    int first = c->n_iov - iovcnt;
+    for (int j = 0; j < iovcnt; j++) {
+        struct io_uring_sqe *s = uring_get_sqe(&c->ring);
+        if (s == NULL) {
+            break;
+        }
+        a4_prep_send_fixed(s, c->fd, &iov[j], (unsigned)(first + j));
+        a4_target(c, s);
+        c->inflight++;
+        c->zc_sqes++;
+        sqe = s;
+    }
+    return sqe;
+}
+
+// ===========================================================================
+//  a4_reap
+// ===========================================================================
+//  Consumes every available CQE.  Completions of a link chain arrive in
+//  submission order, so bytes are credited to messages in stream order.
+//  A short result breaks the chain (later links complete -ECANCELED and
+//  sent nothing); msg_off then records where the next batch must resume.
+//
+//  Zero-copy notification CQEs (F_NOTIF) only release buffer pages; they
+//  are tallied separately and never count against inflight.  They may be
+//  posted before the send CQE they belong to, so only the totals pair up.
+// ---------------------------------------------------------------------------
+static void a4_reap(a4_conn_t *c)
+{
+    struct io_uring_cqe *cqe;
+
+    while ((cqe = uring_peek_cqe(&c->ring)) != NULL) {
+        int  res   = cqe->res;
+        bool notif = (cqe->flags & IORING_CQE_F_NOTIF) != 0;
+        uring_cqe_seen(&c->ring);
+
+        if (notif) {
+            if ((unsigned)res & IORING_NOTIF_USAGE_ZC_COPIED) {
+                c->notifs_copied++;
+            } else {
+                c->notifs_zc++;
+            }
+            continue;
+        }
+
+        c->inflight--;
+
+        if (res == -ECANCELED) {
+            continue;               /* Link broken earlier — not sent */
+        }
+        if (res < 0) {
+            if (!c->failed) {
+                if (res == -EPIPE || res == -ECONNRESET) {
+                    printf("[Server-A4] Thread %lu: client gone (%s)\n",
+                           (unsigned long)pthread_self(), strerror(-res));
+                } else {
+                    fprintf(stderr, "[Server-A4] sendmsg SQE: %s\n",
+                            strerror(-res));
+                }
+            }
+            c->failed = true;
+            continue;
+        }
+        if (res == 0) {
+            if (!c->failed) {
+                printf("[Server-A4] Thread %lu: client disconnected\n",
+                       (unsigned long)pthread_self());
+            }
+            c->failed = true;
+            continue;
+        }
+
+        c->total_bytes_sent += (size_t)res;
+        c->msg_off          += (size_t)res;
+        if (c->msg_off == c->msg_size) {
+            c->msg_off = 0;
+            c->total_messages++;
+        }
+    }
+}
+
+// ===========================================================================
+//  a4_pending_notifs
+// ===========================================================================
+static size_t a4_pending_notifs(const a4_conn_t *c)
+{
+    return c->zc_sqes - (c->notifs_zc + c->notifs_copied);
+}
+
+// ===========================================================================
+//  a4_drain
+// ===========================================================================
+//  Blocks in io_uring_enter(GETEVENTS) until every submitted SQE has
+//  completed and every zero-copy notification has arrived, for at most
+//  DRAIN_TIMEOUT_MS in total.  The GETEVENTS enter also flushes CQEs that
+//  overflowed the CQ ring.  Returns true if nothing is left outstanding.
+// ---------------------------------------------------------------------------
+static bool a4_drain(a4_conn_t *c)
+{
+    double deadline_us = get_time_us() + DRAIN_TIMEOUT_MS * 1000.0;
+
+    a4_reap(c);
+    while (c->inflight > 0 || a4_pending_notifs(c) > 0) {
+        int left_ms = (int)((deadline_us - get_time_us()) / 1000.0);
+        if (left_ms <= 0) {
+            break;
+        }
+        if (uring_wait(&c->ring, 1, left_ms) < 0 &&
+            errno != EINTR && errno != ETIME) {
+            perror("[Server-A4] io_uring_enter(GETEVENTS)");
+            break;
+        }
+        a4_reap(c);
+    }
+    return c->inflight == 0 && a4_pending_notifs(c) == 0;
+}
+
+// ===========================================================================
+//  a4_step
+// ===========================================================================
+//  One step = one batch: queue qd messages' worth of linked SQEs (the
+//  first finishing a partially sent message if needed), then submit them
+//  and wait for all their completions with a SINGLE io_uring_enter().
+// ---------------------------------------------------------------------------
+static conn_status_t a4_step(void *arg)
+{
+    a4_conn_t *c = (a4_conn_t *)arg;
+
+    /* ---- Build the batch ---------------------------------------------- */
+    struct io_uring_sqe *last = NULL;
+    for (unsigned n = 0; n < c->qd; n++) {
+        struct io_uring_sqe *sqe =
+            a4_queue_message(c, (n == 0) ? c->msg_off : 0);
+        if (sqe == NULL) {
+            break;
+        }
+        last = sqe;
+    }
+    if (last != NULL) {
+        last->flags &= (__u8)~IOSQE_IO_LINK;   /* Chain ends here */
+    }
+
+    /*
+     * ---- Submit + wait: one system call for the whole batch ----------
+     * (SQPOLL: no system call — the poller picks the SQEs up and we
+     * busy-poll the CQ ring below instead of sleeping in the kernel.)
+     */
+    bool spin = c->ring.sqpoll;
+    int  ret  = uring_submit(&c->ring, spin ? 0 : c->inflight);
+    if (ret < 0 && errno != EINTR) {
+        perror("[Server-A4] io_uring_enter");
+        return CONN_CLOSED;
+    }
+    c->batches++;
+
+    /* ---- Reap completions in bulk (no syscall while CQEs are ready) --- */
+    a4_reap(c);
+    while (c->inflight > 0 && g_running) {
+        /*
+         * A spinning sender still has to enter the kernel when lagging
+         * zero-copy notifications overflowed the CQ ring.
+         */
+        if ((!spin || uring_cq_overflowed(&c->ring)) &&
+            uring_submit(&c->ring, c->inflight) < 0 && errno != EINTR) {
+            perror("[Server-A4] io_uring_enter");
+            return CONN_CLOSED;
+        }
+        a4_reap(c);
+    }
+
+    return c->failed ? CONN_CLOSED : CONN_PROGRESS;
+}
+
+// ===========================================================================
+//  a4_close
+// ===========================================================================
+static void a4_close(void *arg)
+{
+    a4_conn_t *c = (a4_conn_t *)arg;
+
+    /*
+     * Zero-copy sends keep referencing the buffers until their F_NOTIF
+     * CQE arrives, i.e. until the socket's write queue lets go of the
+     * skbs.  close() would not end the connection here: with --sqpoll the
+     * socket is also held by the ring's file table.  shutdown() does, on
+     * the socket itself — sends still in flight fail, and the queued data
+     * is ACKed (or the peer resets) — and then the CQ is waited on.
+     *
+     * uring_exit() only unmaps the rings and closes the ring fd; the
+     * kernel cancels whatever is still in flight asynchronously after
+     * that, and until then SEND_ZC / SENDMSG_ZC keep reading the message
+     * buffers (and the msghdr / iovecs in *c).  So every SQE must have
+     * completed — and every notification arrived — before any of it is
+     * freed.  If that does not happen within the bound, it is leaked.
+     */
+    shutdown(c->fd, SHUT_RDWR);
+    bool idle = a4_drain(c);
+    uring_exit(&c->ring);           /* Drops the file-table reference */
+    close(c->fd);
+
+    /* ---- Report per-connection statistics ----------------------------- */
+    double elapsed_us = get_time_us() - c->start_time;
+    double elapsed_s  = elapsed_us / 1e6;
+    double throughput = (elapsed_s > 0.0)
+        ? ((double)c->total_bytes_sent * 8.0) / (elapsed_s * 1e9)
+        : 0.0;
+    double enters_per_msg = (c->total_messages > 0)
+        ? (double)c->ring.enter_calls / (double)c->total_messages
+        : 0.0;
+    double cpu_s = get_thread_cpu_s() - c->start_cpu;
+
+    printf("[Server-A4] Thread %lu: sent %zu msgs (%zu bytes) in %.2f s "
+           "— %.4f Gbps\n",
+           (unsigned long)pthread_self(),
+           c->total_messages, c->total_bytes_sent, elapsed_s, throughput);
+    printf("[Server-A4] Thread %lu: qd=%u, %zu batches, %zu io_uring_enter "
+           "calls (%.4f syscalls/msg)\n",
+           (unsigned long)pthread_self(), c->qd, c->batches,
+           c->ring.enter_calls, enters_per_msg);
+    printf("[Server-A4] Thread %lu: sender CPU %.2f s (%.0f%% of wall)\n",
+           (unsigned long)pthread_self(), cpu_s,
+           (elapsed_s > 0.0) ? 100.0 * cpu_s / elapsed_s : 0.0);
+    if (c->ring.sqpoll) {
+        printf("[Server-A4] Thread %lu: sqpoll cpu=%d, %zu poller wake-ups, "
+               "shared poller CPU so far %.2f s\n",
+               (unsigned long)pthread_self(), g_sqpoll_cpu,
+               c->ring.sq_wakeups, a4_sqpoll_cpu_s());
+    }
+    if (c->zc != A4_ZC_NONE && g_zc_usage) {
+        printf("[Server-A4] Thread %lu: zc=%s, notifications: %zu zero-copy, "
+               "%zu copied, %zu unreaped\n",
+               (unsigned long)pthread_self(), a4_zc_names[c->zc],
+               c->notifs_zc, c->notifs_copied, a4_pending_notifs(c));
+    } else if (c->zc != A4_ZC_NONE) {
+        printf("[Server-A4] Thread %lu: zc=%s, notifications: %zu, "
+               "%zu unreaped (zero-copy / copied split needs Linux 6.2)\n",
+               (unsigned long)pthread_self(), a4_zc_names[c->zc],
+               c->notifs_zc + c->notifs_copied, a4_pending_notifs(c));
+    }
+
+    /* ---- Cleanup ------------------------------------------------------ */
+    if (!idle) {
+        fprintf(stderr, "[Server-A4] Thread %lu: %u SQEs / %zu notifications "
+                "still outstanding — leaking their buffers\n",
+                (unsigned long)pthread_self(), c->inflight,
+                a4_pending_notifs(c));
+        return;
+    }
+    free_message(&c->msg);
+    free(c->iov);
+    free(c->tail_iov);
+    free(c);
+}
+
+static const conn_ops_t a4_ops = {
+    .tag         = "[Server-A4]",
+    .banner      = "Batched io_uring (IORING_OP_SENDMSG + iovec)",
+    .open        = a4_open,
+    .step        = a4_step,
+    .on_error    = NULL,
+    .close       = a4_close,
+    .extra_opts  = a4_long_opts,
+    .extra_short = "q:z:s:",
+    .extra_usage = "  -q, --qd N                Messages per batch "
+                   "(default: 8)\n"
+                   "  -z, --zc fixed|msg        Zero-copy send: SEND_ZC on "
+                   "registered buffers,\n"
+                   "                            or SENDMSG_ZC on the iovec\n"
+                   "  -s, --sqpoll CPU|any      Kernel SQ polling thread "
+                   "(pinned to CPU),\n"
+                   "                            registered socket, no "
+                   "syscalls per batch\n",
+    .parse_opt   = a4_parse_opt,
+    .init        = a4_init,
+    .thread_only = true,
+};
+
+// ===========================================================================
+//  main
+// ===========================================================================
+int main(int argc, char *argv[])
+{
+    return server_main(argc, argv, &a4_ops);
+}
@@ -0,0 +1,42 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_Part_A5_Client.c
+// Purpose: Splice Zero-Copy TCP Client (paired with the A5 server)
+//
+//          Companion client for the A5 vmsplice()/splice() server.  The
+//          receive path is the shared client runtime:
+//
+//            • vmsplice/splice is a SEND-side technique.  The server moves
+//              page references instead of bytes into its socket, but the
+//              resulting TCP byte stream is identical to the A3 server's,
+//              so A3 vs A5 runs compare the two zero-copy send routes.
+//
+//            • Use --recv zerocopy for an end-to-end zero-copy data point.
+//
+// Usage:
+//   ./MT25082_Part_A5_Client [options]
+//       <server_ip> <port> <msg_size> <threads> <duration>
+//
+//   The options (--recv engine, --ring, --spin, --busy-poll, --nfields,
+//   --profile, --pool, --mlock, --numa, --cpus, --rt) are shared by every
+//   client and listed in MT25082_client.h.
+//
+// Example:
+//   ./MT25082_Part_A5_Client 10.0.0.1 9094 65536 4 10
+// =============================================================================
+
+#include "MT25082_client.h"
+
+static const client_info_t a5_info = {
+    .tag     = "[Client-A5]",
+    .banner  = "Splice Client (paired with vmsplice/splice server)",
+    .summary = "A5 — Splice",
+};
+
+// ===========================================================================
+//  main
+// ===========================================================================
+int main(int argc, char *argv[])
+{
+    return client_main(argc, argv, &a5_info);
+}
@@ -0,0 +1,588 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_Part_A5_Server.c
+// Purpose: Zero-Copy TCP Server using vmsplice() + splice() through a pipe
+//
+//          An alternative zero-copy route to A3's MSG_ZEROCOPY.  The message
+//          fields are page-aligned heap buffers; each message is attached
+//          to a per-connection pipe with vmsplice(SPLICE_F_GIFT), which
+//          stores references to the user pages in the pipe buffers instead
+//          of copying the bytes, and splice() then moves those page
+//          references from the pipe into the socket's send queue.
+//
+// Splice Data Path:
+// =================
+//
+//   User Space                  Kernel Space                      Hardware
+//  +-----------+  vmsplice   +------+  splice   +--------------+  +--------+
+//  | message_t | ==========> | pipe | ========> | socket send  |->|  NIC   |
+//  | (aligned  |  page refs  | bufs |  page refs| queue (skb   |  |TX ring |
+//  |  pages)   |  no copy    |      |  no copy  | frags)       |  +--------+
+//  +-----------+             +------+           +--------------+
+//
+//   • Like MSG_ZEROCOPY, the user pages are referenced by in-flight skbs
+//     until the peer ACKs them — rewriting a buffer before then would
+//     change bytes that may still be (re)transmitted.  Unlike
+//     MSG_ZEROCOPY there is no completion notification, so this server
+//     keeps a RING of K messages and only reuses a slot once SIOCOUTQ
+//     shows that every byte of its previous send has been acknowledged.
+//   • Every message gets fresh content (its sequence number stamped into
+//     field 0) before it is spliced, so a premature reuse would be
+//     visible on the wire.
+//   • Two system calls per message (vmsplice + splice) versus one
+//     sendmsg() for A3, but no page pinning per send, no error-queue
+//     draining, and no silent fallback to copying.
+//
+// Usage:
+//   ./MT25082_Part_A5_Server [--ring K] <port> <message_size_bytes>
+//
+// Ring sizing:
+// ============
+//   Over loopback / veth a slot is only safe to rewrite once the client
+//   has READ it (see Notes), so by default K is derived per connection:
+//
+//     K = ⌈(send-buffer limit + receive-buffer ceiling) / msg_size⌉ + 1
+//
+//   where the receive-buffer ceiling is the larger of tcp_rmem[2] (what
+//   autotuning may grow the client's buffer to) and 2 × rmem_max (what an
+//   explicit SO_RCVBUF may ask for), and K is capped at RING_MAX_SLOTS.
+//   SO_SNDBUF is then pinned to at most K × msg_size: the send queue can
+//   never hold more than the ring, so a slot that is still unACKed means a
+//   full queue, and POLLOUT — which only reports free queue space — does
+//   track the ACKs the wait needs.  A ring (default-capped or --ring K)
+//   too small to cover both buffers is reported when the connection opens.
+//
+// Notes:
+//   • SPLICE_F_GIFT is only a hint — current kernels never steal gifted
+//     pages for socket sends; the pages are referenced, not donated, which
+//     is exactly why the ring discipline above is required.
+//   • ACK-based reuse is only safe on a real NIC path, where the receiver
+//     gets its own copy of the bytes.  Over loopback / veth the skb queued
+//     at the receiver shares its page frags with the sender, and the ACK
+//     goes out when the data is queued there, not when it is read: a slot
+//     rewritten after its ACK can change bytes still unread in the
+//     client's receive queue.  There the ring has to cover the client's
+//     receive buffer as well as our send queue (--ring K with
+//     K × msg_size > SO_SNDBUF + the peer's SO_RCVBUF) for the data to
+//     stay intact — which is what the default K provides.
+// =============================================================================
+
+#define _GNU_SOURCE             /* vmsplice, splice, F_SETPIPE_SZ            */
+
+#include "MT25082_server.h"
+
+#include <fcntl.h>              /* splice, vmsplice, fcntl(F_SETPIPE_SZ)     */
+#include <limits.h>             /* INT_MAX                                   */
+#include <poll.h>               /* poll (waiting for ACKs)                   */
+#include <sys/ioctl.h>          /* ioctl                                     */
+#include <linux/sockios.h>      /* SIOCOUTQ                                  */
+
+#define RING_MAX_SLOTS      4096 /* Upper bound on K (default and --ring)    */
+#define ACK_POLL_MS         100 /* Max poll() between g_running checks       */
+#define ACK_SLEEP_MIN_US    50  /* Floor of the RTT-bounded re-check sleep   */
+#define CLOSE_DRAIN_MS      1000 /* Bound on waiting for the final ACKs      */
+
+// ---------------------------------------------------------------------------
+//  Server-specific options
+// ---------------------------------------------------------------------------
+static unsigned g_ring_slots = 0;       /* 0 = derive per connection     */
+
+static const struct option a5_long_opts[] = {
+    { "ring", required_argument, NULL, 'k' },
+    { NULL,   0,                 NULL,  0  }
+};
+
+static int a5_parse_opt(int c, const char *arg)
+{
+    switch (c) {
+    case 'k':
+        g_ring_slots = (unsigned)atoi(arg);
+        if (g_ring_slots == 0 || g_ring_slots > RING_MAX_SLOTS) {
+            fprintf(stderr, "[Server-A5] Ring size must be 1..%d\n",
+                    RING_MAX_SLOTS);
+            return -1;
+        }
+        return 0;
+    default:
+        return -1;
+    }
+}
+
+// ===========================================================================
+//  a5_slot_t
+// ===========================================================================
+//  One ring entry: a page-aligned message, its iovec, and the stream
+//  offset just past the last byte of its most recent send (0 = never
+//  sent), which must be ACKed before the slot may be rewritten.
+// ---------------------------------------------------------------------------
+typedef struct {
+    message_t    msg;
+    struct iovec *iov;                  /* Fields (see message_iov())        */
+    size_t       end_off;
+} a5_slot_t;
+
+// ===========================================================================
+//  a5_conn_t
+// ===========================================================================
+typedef struct {
+    int        fd;                      /* Connected socket                  */
+    size_t     msg_size;                /* Total message size (bytes)        */
+    int        n_iov;                   /* iovec entries per message         */
+    struct iovec *tail;                 /* Unsent part, rebuilt per vmsplice */
+    int        pipe_r;                  /* Pipe read end  (splice source)    */
+    int        pipe_w;                  /* Pipe write end (vmsplice target)  */
+    size_t     pipe_size;               /* Pipe capacity (bytes)             */
+    a5_slot_t *slots;                   /* Ring of K messages                */
+    unsigned   n_slots;
+    unsigned   cur;                     /* Slot being sent                   */
+    size_t     pipe_off;                /* Bytes of current msg in the pipe  */
+    size_t     msg_off;                 /* Bytes of current msg in the socket*/
+    size_t     acked;                   /* Cached: stream bytes ACKed        */
+    size_t     total_bytes_sent;
+    size_t     total_messages;
+    size_t     syscalls;                /* vmsplice + splice                 */
+    size_t     reuse_stalls;            /* Waits for a slot's ACKs           */
+    size_t     ack_checks;              /*   SIOCOUTQ reads while waiting    */
+    size_t     ack_sleeps;              /*   writable-but-unACKed sleeps     */
+    size_t     sndbuf;                  /* Pinned SO_SNDBUF (kernel value)   */
+    double     start_time;
+    double     start_cpu;               /* Thread CPU seconds at open        */
+} a5_conn_t;
+
+// ===========================================================================
+//  a5_sysctl_max
+// ===========================================================================
+//  Last value of a /proc/sys file: the maximum of tcp_rmem / tcp_wmem
+//  ("min default max"), or the single value of rmem_max.  0 if unreadable.
+// ---------------------------------------------------------------------------
+static size_t a5_sysctl_max(const char *path)
+{
+    size_t last = 0;
+    size_t v;
+    FILE  *f = fopen(path, "r");
+    if (f != NULL) {
+        while (fscanf(f, "%zu", &v) == 1) {
+            last = v;
+        }
+        fclose(f);
+    }
+    return last;
+}
+
+// ===========================================================================
+//  a5_size_ring
+// ===========================================================================
+//  Picks K (see "Ring sizing" above) and pins SO_SNDBUF to at most
+//  K × msg_size.  Warns when the ring cannot cover the send-buffer limit
+//  plus the client's receive-buffer ceiling.
+// ---------------------------------------------------------------------------
+static void a5_size_ring(a5_conn_t *c)
+{
+    size_t wmem = a5_sysctl_max("/proc/sys/net/ipv4/tcp_wmem");
+    size_t rmem = a5_sysctl_max("/proc/sys/net/ipv4/tcp_rmem");
+    size_t rcap = 2 * a5_sysctl_max("/proc/sys/net/core/rmem_max");
+    if (rcap > rmem) {
+        rmem = rcap;
+    }
+
+    /* Send-buffer limit before pinning: autotuning may reach tcp_wmem[2] */
+    int       sb  = 0;
+    socklen_t len = sizeof(sb);
+    if (getsockopt(c->fd, SOL_SOCKET, SO_SNDBUF, &sb, &len) == 0 &&
+        (size_t)sb > wmem) {
+        wmem = (size_t)sb;
+    }
+
+    size_t need = wmem + rmem;
+    if (g_ring_slots > 0) {
+        c->n_slots = g_ring_slots;
+    } else {
+        size_t k = (need + c->msg_size - 1) / c->msg_size + 1;
+        c->n_slots = (k > RING_MAX_SLOTS) ? RING_MAX_SLOTS : (unsigned)k;
+    }
+
+    /*
+     * Pin the send queue to the ring.  The kernel doubles the request (for
+     * skb overhead) and reports the doubled value, so ask for half.
+     */
+    size_t ring_bytes = (size_t)c->n_slots * c->msg_size;
+    size_t pin        = (ring_bytes < wmem) ? ring_bytes : wmem;
+    int    req        = (pin / 2 > INT_MAX) ? INT_MAX : (int)(pin / 2);
+    if (setsockopt(c->fd, SOL_SOCKET, SO_SNDBUF, &req, sizeof(req)) < 0) {
+        perror("[Server-A5] setsockopt SO_SNDBUF");
+    }
+    len = sizeof(sb);
+    if (getsockopt(c->fd, SOL_SOCKET, SO_SNDBUF, &sb, &len) == 0) {
+        c->sndbuf = (size_t)sb;
+    }
+
+    need = c->sndbuf + rmem;
+    if (ring_bytes <= need) {
+        fprintf(stderr, "[Server-A5] Thread %lu: ring of %u × %zu B covers "
+                "%.1f of the %.1f MB the send queue and the client's receive "
+                "buffer can hold — over loopback / veth a slot may be "
+                "rewritten before the client reads it\n",
+                (unsigned long)pthread_self(), c->n_slots, c->msg_size,
+                (double)ring_bytes / (1 << 20), (double)need / (1 << 20));
+    }
+}
+
+// ===========================================================================
+//  a5_open
+// ===========================================================================
+//  Sizes the ring (a5_size_ring()), creates the pipe (sized to hold a
+//  whole message where the system limit allows) and the ring of
+//  page-aligned messages.
+// ---------------------------------------------------------------------------
+static void *a5_open(int fd, const server_opts_t *opts, bool nonblocking)
+{
+    (void)nonblocking;  /* thread_only: always a blocking socket */
+
+    a5_conn_t *c = (a5_conn_t *)calloc(1, sizeof(a5_conn_t));
+    if (c == NULL) {
+        perror("[Server-A5] malloc conn");
+        return NULL;
+    }
+
+    c->fd       = fd;
+    c->msg_size = opts->msg_size;
+    a5_size_ring(c);
+
+    printf("[Server-A5] Thread %lu: handling client fd=%d, msg_size=%zu, "
+           "ring=%u, SO_SNDBUF=%zu\n", (unsigned long)pthread_self(), fd,
+           opts->msg_size, c->n_slots, c->sndbuf);
+
+    int p[2];
+    if (pipe(p) < 0) {
+        perror("[Server-A5] pipe");
+        free(c);
+        return NULL;
+    }
+    c->pipe_r = p[0];
+    c->pipe_w = p[1];
+
+    /*
+     * A larger pipe lets one vmsplice()/splice() pair move a whole
+     * message.  Every field occupies at least one pipe buffer (one page
+     * slot), so room for one extra page per field is needed on top of the
+     * payload.  Unprivileged processes are capped by fs.pipe-max-size,
+     * in which case the message simply takes several rounds.
+     */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t want = c->msg_size + (size_t)opts->layout.n_fields * page;
+    int    sz   = fcntl(c->pipe_w, F_SETPIPE_SZ, (int)want);
+    if (sz < 0) {
+        sz = fcntl(c->pipe_w, F_GETPIPE_SZ);
+    }
+    c->pipe_size = (sz > 0) ? (size_t)sz : 0;
+
+    /* ---- Ring of page-aligned messages -------------------------------- */
+    /*
+     * The default --alloc scatter still page-aligns every field; the
+     * single-block layouts are used as given (only "page" keeps every
+     * field page-aligned).
+     */
+    const msg_layout_t *layout = &opts->layout;
+
+    c->slots = (a5_slot_t *)calloc(c->n_slots, sizeof(a5_slot_t));
+    c->tail  = (struct iovec *)calloc((size_t)layout->n_fields,
+                                      sizeof(struct iovec));
+    if (c->slots == NULL || c->tail == NULL) {
+        perror("[Server-A5] malloc ring");
+        free(c->slots);
+        free(c->tail);
+        close(c->pipe_r);
+        close(c->pipe_w);
+        free(c);
+        return NULL;
+    }
+
+    for (unsigned s = 0; s < c->n_slots; s++) {
+        a5_slot_t *slot = &c->slots[s];
+        if (opts->alloc == MSG_ALLOC_SCATTER) {
+            allocate_message_aligned(&slot->msg, layout, page);
+        } else {
+            allocate_message_as(&slot->msg, layout, opts->alloc);
+        }
+        fill_message(&slot->msg, layout);
+        slot->iov = (struct iovec *)calloc((size_t)layout->n_fields,
+                                           sizeof(struct iovec));
+        if (slot->msg.field == NULL || slot->iov == NULL) {
+            perror("[Server-A5] malloc message");
+            for (unsigned t = 0; t <= s; t++) {
+                free_message(&c->slots[t].msg);
+                free(c->slots[t].iov);
+            }
+            free(c->slots);
+            free(c->tail);
+            close(c->pipe_r);
+            close(c->pipe_w);
+            free(c);
+            return NULL;
+        }
+        c->n_iov = message_iov(&slot->msg, layout, 0, layout->n_fields,
+                               slot->iov);
+    }
+
+    c->cur        = c->n_slots - 1;   /* First message advances to slot 0 */
+    c->start_cpu  = get_thread_cpu_s();
+    c->start_time = get_time_us();
+    return c;
+}
+
+// ===========================================================================
+//  a5_wait_acked
+// ===========================================================================
+//  Blocks until the stream is ACKed up to `end_off`, i.e. the socket no
+//  longer references the pages spliced before it.  SIOCOUTQ returns the
+//  bytes still in the send queue (unsent + unACKed), so
+//      acked = total_bytes_sent - outq.
+//
+//  ACKs free send-queue space, so the wait is a poll() for POLLOUT: it
+//  sleeps while the queue is full and wakes as ACKs drain it.  SO_SNDBUF
+//  is pinned to at most the ring (a5_size_ring()), so an unACKed slot
+//  normally means a full queue.  If the socket is nevertheless writable
+//  (a ring of one or two messages, or the final drain at close), no event
+//  marks the ACK: the loop sleeps for a quarter of the smoothed RTT — the
+//  soonest an ACK can be expected — before it checks again.
+//
+//  `deadline_us` (0 = none) bounds the wait; without one it ends when the
+//  server shuts down.  A reset connection never ACKs the rest, so
+//  POLLERR / POLLHUP ends the wait too.  Returns A5_ACKED, or A5_DEAD if
+//  the connection is gone (its send queue purged), or A5_TIMEOUT.
+// ---------------------------------------------------------------------------
+typedef enum { A5_ACKED, A5_DEAD, A5_TIMEOUT } a5_wait_t;
+
+static a5_wait_t a5_wait_acked(a5_conn_t *c, size_t end_off,
+                               double deadline_us)
+{
+    while (c->acked < end_off) {
+        int outq = 0;
+        c->ack_checks++;
+        if (ioctl(c->fd, SIOCOUTQ, &outq) < 0) {
+            perror("[Server-A5] ioctl SIOCOUTQ");
+            return A5_TIMEOUT;
+        }
+        c->acked = c->total_bytes_sent - (size_t)outq;
+        if (c->acked >= end_off) {
+            break;
+        }
+
+        int timeout_ms = ACK_POLL_MS;
+        if (deadline_us > 0.0) {
+            double left_ms = (deadline_us - get_time_us()) / 1000.0;
+            if (left_ms <= 0.0) {
+                return A5_TIMEOUT;
+            }
+            if (left_ms < timeout_ms) {
+                timeout_ms = (int)left_ms + 1;
+            }
+        } else if (!g_running) {
+            return A5_TIMEOUT;
+        }
+
+        struct pollfd pfd = { .fd = c->fd, .events = POLLOUT };
+        int rc = poll(&pfd, 1, timeout_ms);
+        if (rc > 0 && (pfd.revents & (POLLERR | POLLHUP))) {
+            return A5_DEAD;
+        }
+        if (rc > 0 && (pfd.revents & POLLOUT)) {
+            /* Writable but unACKed: nothing to wait on but the clock */
+            struct tcp_info ti;
+            socklen_t       len      = sizeof(ti);
+            unsigned        sleep_us = ACK_SLEEP_MIN_US;
+            if (getsockopt(c->fd, IPPROTO_TCP, TCP_INFO, &ti, &len) == 0 &&
+                ti.tcpi_rtt / 4 > sleep_us) {
+                sleep_us = ti.tcpi_rtt / 4;
+            }
+            if (sleep_us > (unsigned)timeout_ms * 1000U) {
+                sleep_us = (unsigned)timeout_ms * 1000U;
+            }
+            c->ack_sleeps++;
+            usleep(sleep_us);
+        }
+    }
+    return A5_ACKED;
+}
+
+// ===========================================================================
+//  a5_wait_slot
+// ===========================================================================
+//  Waits (without a time bound) until `slot` may be rewritten.  Returns
+//  false if the connection is dead or the server is shutting down.
+// ---------------------------------------------------------------------------
+static bool a5_wait_slot(a5_conn_t *c, const a5_slot_t *slot)
+{
+    if (c->acked >= slot->end_off) {
+        return true;
+    }
+    c->reuse_stalls++;
+    a5_wait_t w = a5_wait_acked(c, slot->end_off, 0.0);
+    if (w == A5_DEAD) {
+        printf("[Server-A5] Thread %lu: client gone (reset while "
+               "waiting for ACKs)\n", (unsigned long)pthread_self());
+    }
+    return w == A5_ACKED;
+}
+
+// ===========================================================================
+//  a5_step
+// ===========================================================================
+//  One step = top up the pipe with vmsplice() (at most once) and move
+//  what it holds to the socket with splice() (at most once).  A new
+//  message first claims the next ring slot and stamps fresh content.
+// ---------------------------------------------------------------------------
+static conn_status_t a5_step(void *arg)
+{
+    a5_conn_t *c    = (a5_conn_t *)arg;
+    a5_slot_t *slot = &c->slots[c->cur];
+
+    /* ---- Start of a message: rotate to a slot the peer has ACKed ------ */
+    if (c->msg_off == 0 && c->pipe_off == 0) {
+        c->cur = (c->cur + 1) % c->n_slots;
+        slot   = &c->slots[c->cur];
+        if (!a5_wait_slot(c, slot)) {
+            return CONN_CLOSED;
+        }
+        size_t stamp = c->total_messages;
+        size_t n     = (slot->iov[0].iov_len < sizeof(stamp))
+                       ? slot->iov[0].iov_len : sizeof(stamp);
+        memcpy(slot->iov[0].iov_base, &stamp, n);
+    }
+
+    /* ---- Gift the unsent part of the message to the pipe -------------- */
+    if (c->pipe_off < c->msg_size && c->pipe_off == c->msg_off) {
+        int cnt = iov_tail(slot->iov, c->n_iov, c->pipe_off, c->tail);
+
+        c->syscalls++;
+        ssize_t n = vmsplice(c->pipe_w, c->tail, (unsigned long)cnt,
+                             SPLICE_F_GIFT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                return CONN_PROGRESS;
+            }
+            perror("[Server-A5] vmsplice");
+            return CONN_CLOSED;
+        }
+        c->pipe_off += (size_t)n;
+    }
+
+    /* ---- Move the pipe's page references into the socket ------------- */
+    size_t in_pipe = c->pipe_off - c->msg_off;
+    c->syscalls++;
+    ssize_t n = splice(c->pipe_r, NULL, c->fd, NULL, in_pipe,
+                       SPLICE_F_MOVE | SPLICE_F_MORE);
+    if (n <= 0) {
+        if (n < 0 && errno == EINTR) {
+            return CONN_PROGRESS;
+        }
+        if (n == 0 || errno == EPIPE || errno == ECONNRESET) {
+            printf("[Server-A5] Thread %lu: client gone (%s)\n",
+                   (unsigned long)pthread_self(),
+                   (n == 0) ? "EOF" : strerror(errno));
+        } else {
+            perror("[Server-A5] splice");
+        }
+        return CONN_CLOSED;
+    }
+
+    c->total_bytes_sent += (size_t)n;
+    c->msg_off          += (size_t)n;
+    if (c->msg_off == c->msg_size) {
+        slot->end_off = c->total_bytes_sent;
+        c->msg_off    = 0;
+        c->pipe_off   = 0;
+        c->total_messages++;
+    }
+
+    return CONN_PROGRESS;
+}
+
+// ===========================================================================
+//  a5_close
+// ===========================================================================
+static void a5_close(void *arg)
+{
+    a5_conn_t *c = (a5_conn_t *)arg;
+
+    /* ---- Report per-connection statistics ----------------------------- */
+    double elapsed_us = get_time_us() - c->start_time;
+    double elapsed_s  = elapsed_us / 1e6;
+    double throughput = (elapsed_s > 0.0)
+        ? ((double)c->total_bytes_sent * 8.0) / (elapsed_s * 1e9)
+        : 0.0;
+    double cpu_s = get_thread_cpu_s() - c->start_cpu;
+
+    printf("[Server-A5] Thread %lu: sent %zu msgs (%zu bytes) in %.2f s "
+           "— %.4f Gbps\n",
+           (unsigned long)pthread_self(),
+           c->total_messages, c->total_bytes_sent, elapsed_s, throughput);
+    printf("[Server-A5] Thread %lu: sender CPU %.2f s (%.3f s/GB), "
+           "%.2f syscalls/msg, pipe %zu bytes, %zu ring stalls "
+           "(%zu SIOCOUTQ checks, %zu RTT sleeps)\n",
+           (unsigned long)pthread_self(), cpu_s,
+           (c->total_bytes_sent > 0)
+               ? cpu_s * 1e9 / (double)c->total_bytes_sent : 0.0,
+           (c->total_messages > 0)
+               ? (double)c->syscalls / (double)c->total_messages : 0.0,
+           c->pipe_size, c->reuse_stalls, c->ack_checks, c->ack_sleeps);
+
+    /*
+     * Skbs still in the send queue reference the gifted ring pages, and
+     * closing the socket would orphan them with those references.  Once
+     * the ring is freed, malloc() may hand the pages to another
+     * connection's messages, whose bytes a late retransmission would then
+     * put on this connection's wire.  So wait (bounded) for SIOCOUTQ to
+     * reach 0 first — or for a reset, which purges the queue — and leak
+     * the ring if the ACKs do not come.
+     */
+    a5_wait_t w = a5_wait_acked(c, c->total_bytes_sent,
+                                get_time_us() + CLOSE_DRAIN_MS * 1000.0);
+    close(c->fd);
+    close(c->pipe_r);
+    close(c->pipe_w);
+
+    /* ---- Cleanup ------------------------------------------------------ */
+    if (w == A5_TIMEOUT) {
+        fprintf(stderr, "[Server-A5] Thread %lu: %zu bytes still unACKed "
+                "after %d ms — leaking the ring\n",
+                (unsigned long)pthread_self(),
+                c->total_bytes_sent - c->acked, CLOSE_DRAIN_MS);
+    }
+    for (unsigned s = 0; w != A5_TIMEOUT && s < c->n_slots; s++) {
+        free_message(&c->slots[s].msg);
+    }
+    for (unsigned s = 0; s < c->n_slots; s++) {
+        free(c->slots[s].iov);
+    }
+    free(c->slots);
+    free(c->tail);
+    free(c);
+}
+
+static const conn_ops_t a5_ops = {
+    .tag         = "[Server-A5]",
+    .banner      = "Zero-Copy (vmsplice + splice through a pipe)",
+    .open        = a5_open,
+    .step        = a5_step,
+    .on_error    = NULL,
+    .close       = a5_close,
+    .extra_opts  = a5_long_opts,
+    .extra_short = "k:",
+    .extra_usage = "  -k, --ring K              page-aligned messages rotated "
+                   "per connection\n"
+                   "                            (default: enough to cover "
+                   "SO_SNDBUF + the\n"
+                   "                            client's receive buffer, "
+                   "max 4096)\n",
+    .parse_opt   = a5_parse_opt,
+    .thread_only = true,
+};
+
+// ===========================================================================
+//  main
+// ===========================================================================
+int main(int argc, char *argv[])
+{
+    return server_main(argc, argv, &a5_ops);
+}
@@ -0,0 +1,1584 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_client.c
+// Purpose: Implements the shared client runtime declared in MT25082_client.h.
+//
+// Receive-side data paths:
+// ========================
+//
+//   copy (default):
+//     NIC ──DMA──> sk_buff ──CPU copy (recv)──> heap buffer
+//
+//   zerocopy (TCP_ZEROCOPY_RECEIVE):
+//     NIC ──DMA──> page-backed sk_buff frags ──page-table remap──> mmap area
+//                  (linear / unaligned bytes) ──CPU copy (recv)──> heap
+//
+//   scatter (recvmsg + iovec):
+//     NIC ──DMA──> sk_buff ──CPU copy (recvmsg)──> message_t field 0..n-1
+//
+//   flat (recv + memcpy):
+//     NIC ──DMA──> sk_buff ──CPU copy (recv)──> flat buffer
+//                          ──CPU copy (memcpy)──> message_t field 0..n-1
+//
+//   scatter and flat end in the same place — a rebuilt message_t — so the
+//   difference between them is the cost of the second user-space copy.
+//
+//   discard (recv + MSG_TRUNC):
+//     NIC ──DMA──> sk_buff ──freed──> (nothing reaches user space)
+//
+//   discard runs the same TCP receive path as copy (same recv() calls,
+//   ACKs, window updates) minus the copy, so copy − discard is the cost
+//   of the kernel→user copy itself.
+//
+//   waitall and lowat copy like copy does; they only change when the
+//   thread is woken.  A plain recv() returns (and a blocked reader is
+//   woken) as soon as any segment arrives; MSG_WAITALL returns once the
+//   whole message is in, and SO_RCVLOWAT makes poll() report the socket
+//   readable only when msg_size bytes are queued.
+//
+//   The remap only works for whole, page-aligned payload pages; the kernel
+//   reports the bytes it could not map in recv_skip_hint and we copy those
+//   with an ordinary recv().  Loopback traffic and small MTUs yield mostly
+//   linear skbs, so the mapped share is only meaningful on a real NIC
+//   path (MTU ≥ 4 KB + header split, or a 9000-byte MTU).
+// =============================================================================
+
+#define _GNU_SOURCE             /* sched_getcpu                              */
+
+#include "MT25082_client.h"
+
+#include <getopt.h>             /* getopt_long                               */
+#include <limits.h>             /* INT_MAX                                   */
+#include <poll.h>               /* poll (zerocopy / lowat: wait for data)    */
+#include <sys/resource.h>       /* getrusage(RUSAGE_THREAD)                  */
+#include <sys/mman.h>           /* mmap, munmap                              */
+
+#define ZC_MIN_CHUNK    (256 * 1024) /* Smallest zerocopy mapping (bytes)    */
+#define ZC_POLL_MS      100          /* Max sleep between deadline checks    */
+
+#define RING_DEFAULT    (1024 * 1024)      /* --ring default (bytes)         */
+#define RING_MIN        4096               /* --ring bounds (bytes)          */
+#define RING_MAX        (64 * 1024 * 1024)
+
+#define SPIN_DEFAULT_US 50           /* --spin default (µs)                  */
+
+#define GAP_SUB_BITS    4            /* Gap histogram: 16 linear buckets
+                                        per power of two (≤ 6.25% error)   */
+#define GAP_BUCKETS     (64 << GAP_SUB_BITS)
+
+#define RECV_HIST_BUCKETS 24        /* recv() size histogram: bucket b
+                                       counts returns of 2^b .. 2^(b+1)-1
+                                       bytes, the last one everything
+                                       from 8 MB up                         */
+
+// ===========================================================================
+//  Per-thread result structure
+// ===========================================================================
+//  Each thread writes its results here.  No sharing between threads — the
+//  main thread reads these only after pthread_join(), so no locks needed.
+// ---------------------------------------------------------------------------
+typedef struct {
+    size_t total_bytes;         /* Total bytes received by this thread       */
+    size_t total_messages;      /* Number of complete messages received      */
+    double elapsed_us;          /* Wall-clock time for this thread (µs)      */
+    size_t bytes_mapped;        /* Zerocopy: bytes remapped, never copied    */
+    size_t bytes_copied;        /* Bytes copied into user memory by recv()   */
+    size_t reads;               /* scatter: recvmsg() calls that returned data */
+    size_t partial_reads;       /* ...that stopped inside a message          */
+    size_t bytes_unpacked;      /* flat: bytes memcpy()d into fields         */
+    size_t recv_hist[RECV_HIST_BUCKETS]; /* recv() engines: bytes per call  */
+    size_t polls;               /* lowat: poll() calls that found data       */
+    size_t bytes_discarded;     /* discard: bytes dropped by MSG_TRUNC       */
+    long   nvcsw;               /* Voluntary context switches (= wakeups)    */
+    long   nivcsw;              /* Involuntary context switches (preempted)  */
+    double user_us;             /* CPU time in user mode (µs)                */
+    double sys_us;              /* CPU time in the kernel (µs)               */
+    size_t spin_wins;           /* spin: waits ended by data while spinning  */
+    size_t spin_blocks;         /* spin: waits that fell back to poll()      */
+    uint64_t last_arrival_ns;   /* Previous read that completed a message    */
+    uint64_t gap_max_ns;        /* Longest inter-arrival gap (ns)            */
+    size_t gap_samples;         /* Reads that completed >= 1 message         */
+    size_t gap_hist[GAP_BUCKETS]; /* Inter-arrival gaps, see gap_bucket()    */
+    int    node;                /* --numa home node, or NUMA_OFF             */
+    char   where[96];           /* --numa: where the buffers landed          */
+    int    final_cpu;           /* CPU the thread ended on, or -1            */
+    int    rx_cpu;              /* Socket's last SO_INCOMING_CPU, or -1      */
+} thread_result_t;
+
+// ===========================================================================
+//  Thread arguments
+// ===========================================================================
+typedef struct {
+    const client_opts_t *opts;   /* Parsed command line (shared, read-only) */
+    const client_info_t *info;   /* Log tag                                 */
+    int                  index;  /* Thread number (--cpus LIST slot)        */
+    int                  node;   /* --numa home node, or NUMA_OFF           */
+    thread_result_t     *result; /* Where to write results (caller-owned)   */
+} client_thread_args_t;
+
+// ===========================================================================
+//  thread_node
+// ===========================================================================
+//  Home node of client thread i: the node of its --cpus CPU when both
+//  options are given, otherwise the --numa choice (NUMA_OFF without it).
+// ---------------------------------------------------------------------------
+static int thread_node(const client_opts_t *opts, int i)
+{
+    if (opts->pin == CPU_PIN_LIST && opts->numa != NUMA_OFF) {
+        return numa_cpu_node(opts->cpus[i % opts->n_cpus]);
+    }
+    return numa_pick(opts->numa, i);
+}
+
+// ===========================================================================
+//  Inter-arrival gaps
+// ===========================================================================
+//  Messages carry no send timestamp, so the client cannot measure their
+//  latency.  What it records is the gap between two reads that each
+//  completed at least one message — one sample per such read, however
+//  many messages it completed.  Against a saturated sender this is the
+//  consumer's own pace (a throughput view), not a delivery latency.
+//  Gaps go into a log-linear histogram — values below 2^GAP_SUB_BITS ns
+//  exactly, larger ones in 2^GAP_SUB_BITS equal steps per power of two —
+//  which threads merge by addition.
+// ---------------------------------------------------------------------------
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int gap_bucket(uint64_t ns)
+{
+    if (ns < (1U << GAP_SUB_BITS)) {
+        return (int)ns;
+    }
+    int e = 63 - __builtin_clzll(ns);
+    int sub = (int)(ns >> (e - GAP_SUB_BITS)) & ((1 << GAP_SUB_BITS) - 1);
+    return ((e - GAP_SUB_BITS + 1) << GAP_SUB_BITS) + sub;
+}
+
+/* Largest gap that lands in bucket b (what percentiles report) */
+static uint64_t gap_bucket_top(int b)
+{
+    if (b < (1 << GAP_SUB_BITS)) {
+        return (uint64_t)b;
+    }
+    int      e   = (b >> GAP_SUB_BITS) + GAP_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(b & ((1 << GAP_SUB_BITS) - 1));
+    return (((1ULL << GAP_SUB_BITS) + sub + 1) << (e - GAP_SUB_BITS)) - 1;
+}
+
+// ---------------------------------------------------------------------------
+//  note_messages — counts k (> 0) messages completed by one read and
+//  records one gap sample: the time since the previous such read.
+// ---------------------------------------------------------------------------
+static void note_messages(thread_result_t *result, size_t k)
+{
+    uint64_t now = now_ns();
+    uint64_t gap = now - result->last_arrival_ns;
+
+    result->gap_hist[gap_bucket(gap)]++;
+    result->gap_samples++;
+    if (gap > result->gap_max_ns) {
+        result->gap_max_ns = gap;
+    }
+    result->last_arrival_ns     = now;
+    result->total_messages += k;
+}
+
+// ===========================================================================
+//  account
+// ===========================================================================
+//  Credits n received bytes and counts every message boundary crossed.
+// ---------------------------------------------------------------------------
+static void account(thread_result_t *result, size_t *bytes_in_msg,
+                    size_t msg_size, size_t n)
+{
+    size_t done = 0;
+
+    result->total_bytes += n;
+    *bytes_in_msg       += n;
+
+    while (*bytes_in_msg >= msg_size) {
+        done++;
+        *bytes_in_msg -= msg_size;
+    }
+    if (done > 0) {
+        note_messages(result, done);
+    }
+}
+
+// ===========================================================================
+//  note_recv
+// ===========================================================================
+//  Adds one recv() return of n (> 0) bytes to the size histogram.
+// ---------------------------------------------------------------------------
+static void note_recv(thread_result_t *result, size_t n)
+{
+    int b = 63 - __builtin_clzl((unsigned long)n);
+    if (b >= RECV_HIST_BUCKETS) {
+        b = RECV_HIST_BUCKETS - 1;
+    }
+    result->recv_hist[b]++;
+}
+
+// ===========================================================================
+//  recv_copy
+// ===========================================================================
+//  The original PA02 receive loop: recv() into a private heap buffer of
+//  msg_size bytes until the deadline passes or the server goes away.
+//
+//  recv() performs the kernel→user copy regardless of how the server sent
+//  the data (send, sendmsg, MSG_ZEROCOPY, io_uring) — TCP is a byte stream
+//  and the receiver cannot tell the implementations apart.
+// ---------------------------------------------------------------------------
+static void recv_copy(int sock_fd, const client_opts_t *opts,
+                      const char *tag, thread_result_t *result,
+                      double deadline_us)
+{
+    size_t msg_size = opts->msg_size;
+
+    /*
+     * Each thread gets its own buffer — no sharing, no locks needed.
+     * The buffer size matches msg_size so we can count complete messages.
+     */
+    char *recv_buf = (char *)pool_alloc(msg_size, 0);
+    if (recv_buf == NULL) {
+        fprintf(stderr, "%s malloc recv_buf: %s\n", tag, strerror(errno));
+        return;
+    }
+
+    size_t bytes_in_msg = 0;
+
+    while (get_time_us() < deadline_us) {
+        ssize_t n = recv(sock_fd,
+                         recv_buf + bytes_in_msg,
+                         msg_size - bytes_in_msg,
+                         0);
+
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR) {
+                continue;   /* Signal interrupted recv(), retry */
+            } else {
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_copied += (size_t)n;
+        note_recv(result, (size_t)n);
+        account(result, &bytes_in_msg, msg_size, (size_t)n);
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(recv_buf);
+}
+
+// ===========================================================================
+//  recv_ring
+// ===========================================================================
+//  recv() asks for all the free space up to the end of a ring of
+//  opts->ring_bytes, so one call returns whatever the socket has queued
+//  (up to the ring) instead of at most one message.  Complete messages
+//  are then split out in place.
+//
+//  The ring is a whole number of messages, so a message never wraps: once
+//  the write offset reaches the end every message in the ring is complete
+//  and consumed, and the next recv() starts again at offset 0.
+//
+//    ring:  | msg | msg | msg | msg | ms.     (free)       |
+//           0                       ^ consumed  ^ head      ^ ring_bytes
+// ---------------------------------------------------------------------------
+static void recv_ring(int sock_fd, const client_opts_t *opts,
+                      const char *tag, thread_result_t *result,
+                      double deadline_us)
+{
+    size_t msg_size = opts->msg_size;
+    size_t cap      = opts->ring_bytes;
+
+    char *ring = (char *)pool_alloc(cap, 0);
+    if (ring == NULL) {
+        fprintf(stderr, "%s malloc ring: %s\n", tag, strerror(errno));
+        return;
+    }
+
+    size_t head     = 0;        /* Next byte recv() writes                   */
+    size_t consumed = 0;        /* Start of the first incomplete message     */
+
+    while (get_time_us() < deadline_us) {
+        ssize_t n = recv(sock_fd, ring + head, cap - head, 0);
+
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_copied += (size_t)n;
+        result->total_bytes  += (size_t)n;
+        note_recv(result, (size_t)n);
+        head += (size_t)n;
+
+        /* Split out every message the ring now holds in full */
+        size_t done = 0;
+        while (head - consumed >= msg_size) {
+            done++;
+            consumed += msg_size;
+        }
+        if (done > 0) {
+            note_messages(result, done);
+        }
+        if (head == cap) {
+            head     = 0;       /* consumed == cap: ring is empty again */
+            consumed = 0;
+        }
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(ring);
+}
+
+// ===========================================================================
+//  recv_scatter
+// ===========================================================================
+//  recvmsg() straight into the fields of one preallocated message_t.  The
+//  iovec covers exactly one message, so a read never crosses a message
+//  boundary; a short read leaves the cursor inside the message and the
+//  next recvmsg() continues from the first unfilled byte (the head entry
+//  is trimmed in place, see iov_cursor_t).  Empty fields get no entry.
+// ---------------------------------------------------------------------------
+static void recv_scatter(int sock_fd, const client_opts_t *opts,
+                         const char *tag, thread_result_t *result,
+                         double deadline_us)
+{
+    message_t msg;
+    allocate_message(&msg, &opts->layout);
+    if (msg.field == NULL) {
+        fprintf(stderr, "%s allocate_message failed\n", tag);
+        return;
+    }
+
+    struct iovec iov[MAX_FIELDS];
+    int          n_iov = message_iov(&msg, &opts->layout, 0,
+                                     opts->layout.n_fields, iov);
+    iov_cursor_t cur;
+    memset(&cur, 0, sizeof(cur));
+    iov_cursor_start(&cur, iov, n_iov, opts->msg_size);
+
+    while (get_time_us() < deadline_us) {
+        struct msghdr mh;
+        memset(&mh, 0, sizeof(mh));
+        mh.msg_iov    = cur.iov;
+        mh.msg_iovlen = (size_t)cur.iovcnt;
+
+        ssize_t n = recvmsg(sock_fd, &mh, 0);
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                fprintf(stderr, "%s recvmsg: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_copied   += (size_t)n;
+        result->total_bytes    += (size_t)n;
+        size_t done = iov_cursor_advance(&cur, (size_t)n);
+        if (done > 0) {
+            note_messages(result, done);
+        }
+        if (iov_cursor_done(&cur)) {
+            iov_cursor_start(&cur, iov, n_iov, opts->msg_size);
+        }
+    }
+
+    result->reads         = cur.writes;
+    result->partial_reads = cur.partial_writes;
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    free_message(&msg);
+}
+
+// ===========================================================================
+//  recv_flat
+// ===========================================================================
+//  The two-step path: recv() into a flat msg_size buffer exactly like the
+//  copy engine, then unpack each completed message into the fields of a
+//  preallocated message_t with one memcpy() per field.
+// ---------------------------------------------------------------------------
+static void recv_flat(int sock_fd, const client_opts_t *opts,
+                      const char *tag, thread_result_t *result,
+                      double deadline_us)
+{
+    const msg_layout_t *layout   = &opts->layout;
+    size_t              msg_size = opts->msg_size;
+
+    message_t msg;
+    allocate_message(&msg, layout);
+    char *flat = (char *)pool_alloc(msg_size, 0);
+    if (msg.field == NULL || flat == NULL) {
+        fprintf(stderr, "%s malloc flat buffer / message failed\n", tag);
+        pool_free(flat);
+        free_message(&msg);
+        return;
+    }
+
+    size_t bytes_in_msg = 0;
+
+    while (get_time_us() < deadline_us) {
+        ssize_t n = recv(sock_fd, flat + bytes_in_msg,
+                         msg_size - bytes_in_msg, 0);
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_copied += (size_t)n;
+        note_recv(result, (size_t)n);
+        result->total_bytes  += (size_t)n;
+        bytes_in_msg         += (size_t)n;
+
+        if (bytes_in_msg == msg_size) {
+            const char *src = flat;
+            for (int i = 0; i < layout->n_fields; i++) {
+                memcpy(msg.field[i], src, layout->size[i]);
+                src += layout->size[i];
+            }
+            result->bytes_unpacked += msg_size;
+            note_messages(result, 1);
+            bytes_in_msg = 0;
+        }
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(flat);
+    free_message(&msg);
+}
+
+// ===========================================================================
+//  recv_waitall
+// ===========================================================================
+//  recv_copy with MSG_WAITALL: the kernel keeps the thread asleep inside
+//  recv() until the rest of the message is in, so every call returns one
+//  whole message (short only on a signal, error or disconnect).
+// ---------------------------------------------------------------------------
+static void recv_waitall(int sock_fd, const client_opts_t *opts,
+                         const char *tag, thread_result_t *result,
+                         double deadline_us)
+{
+    size_t msg_size = opts->msg_size;
+
+    char *recv_buf = (char *)pool_alloc(msg_size, 0);
+    if (recv_buf == NULL) {
+        fprintf(stderr, "%s malloc recv_buf: %s\n", tag, strerror(errno));
+        return;
+    }
+
+    size_t bytes_in_msg = 0;
+
+    while (get_time_us() < deadline_us) {
+        ssize_t n = recv(sock_fd, recv_buf + bytes_in_msg,
+                         msg_size - bytes_in_msg, MSG_WAITALL);
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR) {
+                continue;
+            } else {
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_copied += (size_t)n;
+        note_recv(result, (size_t)n);
+        account(result, &bytes_in_msg, msg_size, (size_t)n);
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(recv_buf);
+}
+
+// ===========================================================================
+//  recv_lowat
+// ===========================================================================
+//  SO_RCVLOWAT = msg_size: poll() only reports the socket readable (and
+//  TCP only wakes the poller) once a whole message is queued, which the
+//  following non-blocking recv() then takes in one call.  Unless the
+//  receive buffer is locked, the kernel grows it to hold twice the low
+//  watermark.  poll() times out every ZC_POLL_MS to check the deadline.
+//
+//  Returns false if SO_RCVLOWAT cannot be set (caller falls back to the
+//  copy engine), true otherwise.
+// ---------------------------------------------------------------------------
+static bool recv_lowat(int sock_fd, const client_opts_t *opts,
+                       const char *tag, thread_result_t *result,
+                       double deadline_us)
+{
+    size_t msg_size = opts->msg_size;
+    int    lowat    = (msg_size > INT_MAX / 2) ? INT_MAX / 2 : (int)msg_size;
+
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_RCVLOWAT,
+                   &lowat, sizeof(lowat)) < 0) {
+        fprintf(stderr, "%s SO_RCVLOWAT: %s — falling back to recv()\n",
+                tag, strerror(errno));
+        return false;
+    }
+
+    char *recv_buf = (char *)pool_alloc(msg_size, 0);
+    if (recv_buf == NULL) {
+        fprintf(stderr, "%s malloc recv_buf: %s\n", tag, strerror(errno));
+        return true;
+    }
+
+    size_t bytes_in_msg = 0;
+
+    while (get_time_us() < deadline_us) {
+        struct pollfd pfd = { .fd = sock_fd, .events = POLLIN };
+        int rc = poll(&pfd, 1, ZC_POLL_MS);
+        if (rc < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fprintf(stderr, "%s poll: %s\n", tag, strerror(errno));
+            break;
+        }
+        if (rc == 0) {
+            continue;
+        }
+        result->polls++;
+
+        ssize_t n = recv(sock_fd, recv_buf + bytes_in_msg,
+                         msg_size - bytes_in_msg, MSG_DONTWAIT);
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            } else {
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_copied += (size_t)n;
+        note_recv(result, (size_t)n);
+        account(result, &bytes_in_msg, msg_size, (size_t)n);
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(recv_buf);
+    return true;
+}
+
+// ===========================================================================
+//  recv_discard
+// ===========================================================================
+//  recv_copy with MSG_TRUNC and no buffer: TCP consumes the requested bytes
+//  (ACKing and opening the window as usual) but skips the copy to user
+//  space.  The calls ask for the same amounts copy would, so the syscall
+//  pattern matches and only the copy is missing.
+//
+//  Returns false if the kernel does not support MSG_TRUNC on TCP (it then
+//  tries to copy into the NULL buffer and fails with EFAULT); the caller
+//  falls back to the copy engine.
+// ---------------------------------------------------------------------------
+static bool recv_discard(int sock_fd, const client_opts_t *opts,
+                         const char *tag, thread_result_t *result,
+                         double deadline_us)
+{
+    size_t msg_size     = opts->msg_size;
+    size_t bytes_in_msg = 0;
+
+    while (get_time_us() < deadline_us) {
+        ssize_t n = recv(sock_fd, NULL, msg_size - bytes_in_msg, MSG_TRUNC);
+        if (n <= 0) {
+            if (n == 0) {
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else if (errno == EINTR) {
+                continue;
+            } else if (errno == EFAULT && result->total_bytes == 0) {
+                fprintf(stderr, "%s recv(MSG_TRUNC) unsupported — falling "
+                        "back to recv()\n", tag);
+                return false;
+            } else {
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            }
+            break;
+        }
+
+        result->bytes_discarded += (size_t)n;
+        note_recv(result, (size_t)n);
+        account(result, &bytes_in_msg, msg_size, (size_t)n);
+    }
+    return true;
+}
+
+// ===========================================================================
+//  recv_spin
+// ===========================================================================
+//  Spin-then-block: recv(MSG_DONTWAIT) in a tight loop, so a message that
+//  arrives within opts->spin_us of the socket running dry is picked up
+//  without a sleep / wakeup.  Once the budget is spent the thread blocks
+//  in poll() and the next wait starts a fresh budget.  A budget of 0 is
+//  plain poll() + recv(); a budget above the message interval never
+//  blocks (and burns its CPU).
+// ---------------------------------------------------------------------------
+static void recv_spin(int sock_fd, const client_opts_t *opts,
+                      const char *tag, thread_result_t *result,
+                      double deadline_us)
+{
+    size_t msg_size = opts->msg_size;
+
+    char *recv_buf = (char *)pool_alloc(msg_size, 0);
+    if (recv_buf == NULL) {
+        fprintf(stderr, "%s malloc recv_buf: %s\n", tag, strerror(errno));
+        return;
+    }
+
+    size_t bytes_in_msg = 0;
+    double dry_since    = -1.0;     /* When the socket ran dry, or -1 */
+    double now;
+
+    while ((now = get_time_us()) < deadline_us) {
+        ssize_t n = recv(sock_fd, recv_buf + bytes_in_msg,
+                         msg_size - bytes_in_msg, MSG_DONTWAIT);
+        if (n > 0) {
+            if (dry_since >= 0.0) {
+                result->spin_wins++;
+                dry_since = -1.0;
+            }
+            result->bytes_copied += (size_t)n;
+            note_recv(result, (size_t)n);
+            account(result, &bytes_in_msg, msg_size, (size_t)n);
+            continue;
+        }
+        if (n == 0) {
+            printf("%s Thread %lu: server disconnected\n",
+                   tag, (unsigned long)pthread_self());
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+            break;
+        }
+
+        /* ---- Socket dry: keep spinning, or block once the budget is up -- */
+        if (dry_since < 0.0) {
+            dry_since = now;
+        }
+        if (now - dry_since < (double)opts->spin_us) {
+            continue;
+        }
+        result->spin_blocks++;
+        struct pollfd pfd = { .fd = sock_fd, .events = POLLIN };
+        if (poll(&pfd, 1, ZC_POLL_MS) < 0 && errno != EINTR) {
+            fprintf(stderr, "%s poll: %s\n", tag, strerror(errno));
+            break;
+        }
+        dry_since = -1.0;
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(recv_buf);
+}
+
+// ===========================================================================
+//  enable_busy_poll
+// ===========================================================================
+//  SO_BUSY_POLL makes a blocking read (or poll()) on the socket spin on its
+//  NIC receive queue for up to `usec` µs before sleeping; raising it above
+//  net.core.busy_read needs CAP_NET_ADMIN.  SO_PREFER_BUSY_POLL (Linux
+//  5.11) additionally keeps softirq processing from racing the spinner.
+//  Only sockets whose traffic arrives through a NAPI device are polled —
+//  loopback is not.  Failures are reported and otherwise ignored.
+// ---------------------------------------------------------------------------
+static void enable_busy_poll(int sock_fd, int usec, const char *tag)
+{
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_BUSY_POLL,
+                   &usec, sizeof(usec)) < 0) {
+        fprintf(stderr, "%s SO_BUSY_POLL %d: %s\n",
+                tag, usec, strerror(errno));
+        return;
+    }
+#ifdef SO_PREFER_BUSY_POLL
+    int on = 1;
+    if (setsockopt(sock_fd, SOL_SOCKET, SO_PREFER_BUSY_POLL,
+                   &on, sizeof(on)) < 0) {
+        fprintf(stderr, "%s SO_PREFER_BUSY_POLL: %s\n",
+                tag, strerror(errno));
+    }
+#endif
+}
+
+// ===========================================================================
+//  recv_zerocopy
+// ===========================================================================
+//  Receive loop built on getsockopt(TCP_ZEROCOPY_RECEIVE):
+//
+//    1. mmap() a read-only window of the socket once.
+//    2. Each getsockopt() call asks the kernel to map as many whole
+//       payload pages as are queued into that window (replacing the pages
+//       mapped by the previous call) — zc.length returns the byte count.
+//    3. zc.recv_skip_hint reports bytes that cannot be mapped (unaligned
+//       or linear data); they are consumed with a normal recv().
+//    4. With nothing queued, poll() for more data.
+//
+//  Returns false if the socket cannot be mapped (caller falls back to the
+//  copy engine), true otherwise.
+// ---------------------------------------------------------------------------
+static bool recv_zerocopy(int sock_fd, const client_opts_t *opts,
+                          const char *tag, thread_result_t *result,
+                          double deadline_us)
+{
+    size_t page  = (size_t)sysconf(_SC_PAGESIZE);
+    size_t chunk = (opts->msg_size > ZC_MIN_CHUNK) ? opts->msg_size
+                                                   : ZC_MIN_CHUNK;
+    chunk = (chunk + page - 1) & ~(page - 1);
+
+    void *area = mmap(NULL, chunk, PROT_READ, MAP_SHARED, sock_fd, 0);
+    if (area == MAP_FAILED) {
+        fprintf(stderr, "%s mmap(socket): %s — falling back to recv()\n",
+                tag, strerror(errno));
+        return false;
+    }
+
+    char *copy_buf = (char *)pool_alloc(chunk, page);
+    if (copy_buf == NULL) {
+        fprintf(stderr, "%s malloc copy_buf: %s\n", tag, strerror(errno));
+        munmap(area, chunk);
+        return true;
+    }
+
+    size_t bytes_in_msg = 0;
+
+    while (get_time_us() < deadline_us) {
+        struct tcp_zerocopy_receive zc;
+        socklen_t zc_len = sizeof(zc);
+
+        memset(&zc, 0, sizeof(zc));
+        zc.address = (uint64_t)(uintptr_t)area;
+        zc.length  = (uint32_t)chunk;
+
+        if (getsockopt(sock_fd, IPPROTO_TCP, TCP_ZEROCOPY_RECEIVE,
+                       &zc, &zc_len) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EIO) {     /* Peer closed, receive queue empty */
+                printf("%s Thread %lu: server disconnected\n",
+                       tag, (unsigned long)pthread_self());
+            } else {
+                fprintf(stderr, "%s getsockopt(TCP_ZEROCOPY_RECEIVE): %s\n",
+                        tag, strerror(errno));
+            }
+            break;
+        }
+
+        /* ---- Mapped payload: no copy at all --------------------------- */
+        if (zc.length > 0) {
+            result->bytes_mapped += zc.length;
+            account(result, &bytes_in_msg, opts->msg_size, zc.length);
+        }
+
+        /* ---- Unmappable remainder: ordinary copy ---------------------- */
+        if (zc.recv_skip_hint > 0) {
+            size_t  want = (zc.recv_skip_hint < chunk) ? zc.recv_skip_hint
+                                                       : chunk;
+            ssize_t n    = recv(sock_fd, copy_buf, want, 0);
+            if (n <= 0) {
+                if (n == 0) {
+                    printf("%s Thread %lu: server disconnected\n",
+                           tag, (unsigned long)pthread_self());
+                    break;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                fprintf(stderr, "%s recv: %s\n", tag, strerror(errno));
+                break;
+            }
+            result->bytes_copied += (size_t)n;
+            account(result, &bytes_in_msg, opts->msg_size, (size_t)n);
+        }
+
+        /* ---- Nothing queued: sleep until data (or the deadline) ------- */
+        if (zc.length == 0 && zc.recv_skip_hint == 0) {
+            struct pollfd pfd = { .fd = sock_fd, .events = POLLIN };
+            if (poll(&pfd, 1, ZC_POLL_MS) < 0 && errno != EINTR) {
+                fprintf(stderr, "%s poll: %s\n", tag, strerror(errno));
+                break;
+            }
+        }
+    }
+
+    if (result->node != NUMA_OFF) {
+        numa_track_report(result->where, sizeof(result->where));
+    }
+    pool_free(copy_buf);
+    munmap(area, chunk);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+//  timeval_us — a struct rusage time in µs.
+// ---------------------------------------------------------------------------
+static double timeval_us(const struct timeval *tv)
+{
+    return (double)tv->tv_sec * 1e6 + (double)tv->tv_usec;
+}
+
+// ===========================================================================
+//  client_thread
+// ===========================================================================
+//  Thread entry point.  Each thread:
+//    0. With --numa / a --cpus list, moves itself (and its memory policy)
+//       to its node / CPU first, so the socket and the receive buffers are
+//       allocated there.
+//    1. Opens its own TCP connection to the server; with --cpus rx[-next]
+//       it then moves to (next to) the CPU receiving for the socket.
+//    2. Receives with the selected engine until the duration expires.
+//    3. Records bytes received, message count, and elapsed time.
+// ---------------------------------------------------------------------------
+static void *client_thread(void *arg)
+{
+    /* ---- Unpack arguments --------------------------------------------- */
+    client_thread_args_t *cargs  = (client_thread_args_t *)arg;
+    const client_opts_t  *opts   = cargs->opts;
+    const char           *tag    = cargs->info->tag;
+    thread_result_t      *result = cargs->result;
+
+    memset(result, 0, sizeof(*result));
+    result->node      = cargs->node;
+    result->final_cpu = -1;
+    result->rx_cpu    = -1;
+
+    /* ---- CPU / NUMA placement ----------------------------------------- */
+    int cpu = (opts->pin == CPU_PIN_LIST)
+                  ? opts->cpus[cargs->index % opts->n_cpus] : -1;
+    if (cpu >= 0 && pin_thread_to_cpu(cpu) < 0) {
+        fprintf(stderr, "%s cannot pin to CPU %d: %s\n",
+                tag, cpu, strerror(errno));
+    }
+    if (cargs->node != NUMA_OFF) {
+        if ((cpu < 0 && numa_run_on(cargs->node) < 0) ||
+            numa_bind_memory(cargs->node) < 0) {
+            fprintf(stderr, "%s NUMA node %d: %s\n",
+                    tag, cargs->node, strerror(errno));
+        }
+        numa_track_reset();
+    }
+    if (opts->rt_prio > 0 && set_thread_fifo(opts->rt_prio) < 0) {
+        fprintf(stderr, "%s SCHED_FIFO %d: %s\n",
+                tag, opts->rt_prio, strerror(errno));
+    }
+
+    /* ---- Create TCP socket -------------------------------------------- */
+    int sock_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock_fd < 0) {
+        fprintf(stderr, "%s socket: %s\n", tag, strerror(errno));
+        return NULL;
+    }
+
+    /* ---- Connect to server -------------------------------------------- */
+    struct sockaddr_in serv_addr;
+    memset(&serv_addr, 0, sizeof(serv_addr));
+    serv_addr.sin_family = AF_INET;
+    serv_addr.sin_port   = htons((uint16_t)opts->port);
+
+    if (inet_pton(AF_INET, opts->server_ip, &serv_addr.sin_addr) <= 0) {
+        fprintf(stderr, "%s Invalid server IP: %s\n", tag, opts->server_ip);
+        close(sock_fd);
+        return NULL;
+    }
+
+    if (connect(sock_fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
+        fprintf(stderr, "%s connect: %s\n", tag, strerror(errno));
+        close(sock_fd);
+        return NULL;
+    }
+
+    /* Disable Nagle for latency-sensitive measurements */
+    int flag = 1;
+    setsockopt(sock_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+    printf("%s Thread %lu connected to %s:%d\n",
+           tag, (unsigned long)pthread_self(), opts->server_ip, opts->port);
+
+    if (opts->busy_poll_us > 0) {
+        enable_busy_poll(sock_fd, opts->busy_poll_us, tag);
+    }
+
+    /* The SYN-ACK has been processed, so SO_INCOMING_CPU is known */
+    if (opts->pin == CPU_PIN_RX || opts->pin == CPU_PIN_RX_NEXT) {
+        cpu = rx_pin_cpu(socket_rx_cpu(sock_fd), opts->pin);
+        if (cpu >= 0 && pin_thread_to_cpu(cpu) < 0) {
+            fprintf(stderr, "%s cannot pin to CPU %d: %s\n",
+                    tag, cpu, strerror(errno));
+        }
+    }
+
+    /* ---- Receive loop ------------------------------------------------- */
+    struct rusage ru_start, ru_end;
+    getrusage(RUSAGE_THREAD, &ru_start);
+
+    double start_time  = get_time_us();
+    double deadline_us = start_time + (double)opts->duration_sec * 1e6;
+    result->last_arrival_ns = now_ns();
+
+    bool done = false;
+    if (opts->recv_mode == RECV_MODE_ZEROCOPY) {
+        done = recv_zerocopy(sock_fd, opts, tag, result, deadline_us);
+    } else if (opts->recv_mode == RECV_MODE_SCATTER) {
+        recv_scatter(sock_fd, opts, tag, result, deadline_us);
+        done = true;
+    } else if (opts->recv_mode == RECV_MODE_FLAT) {
+        recv_flat(sock_fd, opts, tag, result, deadline_us);
+        done = true;
+    } else if (opts->recv_mode == RECV_MODE_RING) {
+        recv_ring(sock_fd, opts, tag, result, deadline_us);
+        done = true;
+    } else if (opts->recv_mode == RECV_MODE_WAITALL) {
+        recv_waitall(sock_fd, opts, tag, result, deadline_us);
+        done = true;
+    } else if (opts->recv_mode == RECV_MODE_LOWAT) {
+        done = recv_lowat(sock_fd, opts, tag, result, deadline_us);
+    } else if (opts->recv_mode == RECV_MODE_DISCARD) {
+        done = recv_discard(sock_fd, opts, tag, result, deadline_us);
+    } else if (opts->recv_mode == RECV_MODE_SPIN) {
+        recv_spin(sock_fd, opts, tag, result, deadline_us);
+        done = true;
+    }
+    if (!done) {
+        recv_copy(sock_fd, opts, tag, result, deadline_us);
+    }
+
+    result->elapsed_us = get_time_us() - start_time;
+    getrusage(RUSAGE_THREAD, &ru_end);
+    result->nvcsw  = ru_end.ru_nvcsw  - ru_start.ru_nvcsw;
+    result->nivcsw = ru_end.ru_nivcsw - ru_start.ru_nivcsw;
+    result->user_us = timeval_us(&ru_end.ru_utime) -
+                      timeval_us(&ru_start.ru_utime);
+    result->sys_us  = timeval_us(&ru_end.ru_stime) -
+                      timeval_us(&ru_start.ru_stime);
+    result->final_cpu  = sched_getcpu();
+    result->rx_cpu     = socket_rx_cpu(sock_fd);
+
+    /* ---- Cleanup ------------------------------------------------------ */
+    close(sock_fd);
+    return NULL;
+}
+
+// ===========================================================================
+//  usage
+// ===========================================================================
+static void usage(const char *prog)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <server_ip> <port> <msg_size> <threads> "
+            "<duration_sec>\n"
+            "Options:\n"
+            "  -r, --recv copy|zerocopy|scatter|flat|ring|waitall|lowat|\n"
+            "             discard|spin\n"
+            "                            receive engine (default: copy);\n"
+            "                            scatter / flat rebuild a message_t\n"
+            "                            with recvmsg() / recv() + memcpy(),\n"
+            "                            ring reads many messages per recv(),\n"
+            "                            waitall / lowat wake once per message\n"
+            "                            (MSG_WAITALL / SO_RCVLOWAT + poll),\n"
+            "                            discard drops the bytes uncopied\n"
+            "                            (MSG_TRUNC), spin polls with\n"
+            "                            MSG_DONTWAIT before blocking\n"
+            "  -b, --ring BYTES          ring size for --recv ring, %d..%d\n"
+            "                            (default: %d; rounded up to whole\n"
+            "                            messages)\n"
+            "  -S, --spin USEC           --recv spin budget before poll()\n"
+            "                            (default: %d)\n"
+            "  -B, --busy-poll USEC      SO_BUSY_POLL (+ SO_PREFER_BUSY_POLL)\n"
+            "                            on every socket\n"
+            "  -n, --nfields N           fields per message, 1..%d "
+            "(default: %d)\n"
+            "  -p, --profile P           field sizes: uniform | skewed | "
+            "geometric |\n"
+            "                            S0,S1,... (as given to the "
+            "server)\n"
+            "  -P, --pool malloc|thp|hugetlb\n"
+            "                            receive-buffer memory: malloc "
+            "(default),\n"
+            "                            or prefaulted huge-page arenas\n"
+            "  -L, --mlock               mlock() the --pool arenas\n"
+            "  -N, --numa rr|NODE        run each thread on one NUMA node and\n"
+            "                            place its socket and buffers there;\n"
+            "                            rr = thread i on node i mod nodes\n"
+            "  -c, --cpus LIST|rx|rx-next\n"
+            "                            pin thread i to the i-th CPU of LIST,\n"
+            "                            or after connect() to the socket's\n"
+            "                            SO_INCOMING_CPU (rx) or the next CPU\n"
+            "                            on its node (rx-next)\n"
+            "  -R, --rt PRIO             run receive threads SCHED_FIFO at PRIO\n"
+            "                            (1-99; needs CAP_SYS_NICE)\n",
+            prog, RING_MIN, RING_MAX, RING_DEFAULT, SPIN_DEFAULT_US,
+            MAX_FIELDS, NUM_FIELDS);
+}
+
+// ===========================================================================
+//  parse_args
+// ===========================================================================
+static int parse_args(int argc, char *argv[], const client_info_t *info,
+                      client_opts_t *opts)
+{
+    static const struct option long_opts[] = {
+        { "recv",    required_argument, NULL, 'r' },
+        { "nfields", required_argument, NULL, 'n' },
+        { "profile", required_argument, NULL, 'p' },
+        { "pool",    required_argument, NULL, 'P' },
+        { "mlock",   no_argument,       NULL, 'L' },
+        { "numa",    required_argument, NULL, 'N' },
+        { "cpus",    required_argument, NULL, 'c' },
+        { "rt",      required_argument, NULL, 'R' },
+        { "ring",    required_argument, NULL, 'b' },
+        { "spin",    required_argument, NULL, 'S' },
+        { "busy-poll", required_argument, NULL, 'B' },
+        { NULL,      0,                 NULL,  0  }
+    };
+
+    memset(opts, 0, sizeof(*opts));
+    opts->recv_mode = RECV_MODE_COPY;
+    opts->profile   = "uniform";
+    opts->numa      = NUMA_OFF;
+    opts->ring_bytes = RING_DEFAULT;
+    opts->spin_us    = SPIN_DEFAULT_US;
+    numa_discover();
+
+    int n_fields = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, "r:n:p:P:LN:c:R:b:S:B:", long_opts, NULL)) != -1) {
+        switch (c) {
+        case 'r':
+            if (strcmp(optarg, "copy") == 0) {
+                opts->recv_mode = RECV_MODE_COPY;
+            } else if (strcmp(optarg, "zerocopy") == 0) {
+                opts->recv_mode = RECV_MODE_ZEROCOPY;
+            } else if (strcmp(optarg, "scatter") == 0) {
+                opts->recv_mode = RECV_MODE_SCATTER;
+            } else if (strcmp(optarg, "flat") == 0) {
+                opts->recv_mode = RECV_MODE_FLAT;
+            } else if (strcmp(optarg, "ring") == 0) {
+                opts->recv_mode = RECV_MODE_RING;
+            } else if (strcmp(optarg, "waitall") == 0) {
+                opts->recv_mode = RECV_MODE_WAITALL;
+            } else if (strcmp(optarg, "lowat") == 0) {
+                opts->recv_mode = RECV_MODE_LOWAT;
+            } else if (strcmp(optarg, "discard") == 0) {
+                opts->recv_mode = RECV_MODE_DISCARD;
+            } else if (strcmp(optarg, "spin") == 0) {
+                opts->recv_mode = RECV_MODE_SPIN;
+            } else {
+                fprintf(stderr, "%s Unknown receive mode '%s'\n",
+                        info->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'n':
+            n_fields = atoi(optarg);
+            if (n_fields < 1 || n_fields > MAX_FIELDS) {
+                fprintf(stderr, "%s Field count must be 1..%d\n",
+                        info->tag, MAX_FIELDS);
+                return -1;
+            }
+            break;
+        case 'p':
+            opts->profile = optarg;
+            break;
+        case 'P':
+            if (parse_pool_type(optarg, &opts->pool) < 0) {
+                fprintf(stderr, "%s Unknown pool '%s'\n", info->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'L':
+            opts->mlock = true;
+            break;
+        case 'N':
+            if (parse_numa_policy(optarg, &opts->numa) < 0) {
+                fprintf(stderr, "%s --numa: '%s' is not rr or an online "
+                        "node\n", info->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'c':
+            opts->n_cpus = parse_cpu_pin(optarg, &opts->pin, opts->cpus,
+                                         MAX_CPUS);
+            if (opts->n_cpus < 0) {
+                fprintf(stderr, "%s Invalid CPU list: %s\n",
+                        info->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'R':
+            opts->rt_prio = atoi(optarg);
+            if (opts->rt_prio < 1 || opts->rt_prio > 99) {
+                fprintf(stderr, "%s --rt priority must be 1..99\n",
+                        info->tag);
+                return -1;
+            }
+            break;
+        case 'b':
+            opts->ring_bytes = (size_t)strtoull(optarg, NULL, 10);
+            if (opts->ring_bytes < RING_MIN || opts->ring_bytes > RING_MAX) {
+                fprintf(stderr, "%s --ring must be %d..%d bytes\n",
+                        info->tag, RING_MIN, RING_MAX);
+                return -1;
+            }
+            break;
+        case 'S':
+            opts->spin_us = atoi(optarg);
+            if (opts->spin_us < 0) {
+                fprintf(stderr, "%s --spin must be >= 0 µs\n", info->tag);
+                return -1;
+            }
+            break;
+        case 'B':
+            opts->busy_poll_us = atoi(optarg);
+            if (opts->busy_poll_us <= 0) {
+                fprintf(stderr, "%s --busy-poll must be > 0 µs\n",
+                        info->tag);
+                return -1;
+            }
+            break;
+        default:
+            usage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (argc - optind != 5) {
+        usage(argv[0]);
+        return -1;
+    }
+
+    strncpy(opts->server_ip, argv[optind], sizeof(opts->server_ip) - 1);
+    opts->port         = atoi(argv[optind + 1]);
+    opts->msg_size     = (size_t)atol(argv[optind + 2]);
+    opts->n_threads    = atoi(argv[optind + 3]);
+    opts->duration_sec = atoi(argv[optind + 4]);
+
+    /* Validate inputs */
+    if (opts->port <= 0 || opts->port > 65535) {
+        fprintf(stderr, "%s Invalid port: %d\n", info->tag, opts->port);
+        return -1;
+    }
+    if (opts->msg_size == 0) {
+        fprintf(stderr, "%s Message size must be > 0\n", info->tag);
+        return -1;
+    }
+    if (opts->n_threads <= 0) {
+        fprintf(stderr, "%s Thread count must be > 0\n", info->tag);
+        return -1;
+    }
+    if (opts->duration_sec <= 0) {
+        fprintf(stderr, "%s Duration must be > 0\n", info->tag);
+        return -1;
+    }
+    if (message_layout(&opts->layout, opts->msg_size, n_fields,
+                       opts->profile) < 0) {
+        fprintf(stderr, "%s Invalid field layout '%s' for %zu bytes\n",
+                info->tag, opts->profile, opts->msg_size);
+        return -1;
+    }
+    /* Whole messages only, so none wraps around the ring */
+    opts->ring_bytes = (opts->ring_bytes + opts->msg_size - 1) /
+                       opts->msg_size * opts->msg_size;
+    if (opts->mlock && opts->pool == POOL_MALLOC) {
+        fprintf(stderr, "%s --mlock requires --pool thp|hugetlb\n",
+                info->tag);
+        return -1;
+    }
+    return 0;
+}
+
+// ===========================================================================
+//  client_main
+// ===========================================================================
+int client_main(int argc, char *argv[], const client_info_t *info)
+{
+    static const char *const recv_names[] = {
+        "copy", "zerocopy", "scatter", "flat", "ring", "waitall", "lowat",
+        "discard", "spin"
+    };
+
+    /* ---- Parse command-line arguments --------------------------------- */
+    client_opts_t opts;
+    if (parse_args(argc, argv, info, &opts) < 0) {
+        return EXIT_FAILURE;
+    }
+    int n_threads = opts.n_threads;
+
+    printf("%s %s\n", info->tag, info->banner);
+    printf("%s Server: %s:%d | msg_size: %zu | threads: %d | "
+           "duration: %d s | recv: %s | fields: %d (%s)\n",
+           info->tag, opts.server_ip, opts.port, opts.msg_size, n_threads,
+           opts.duration_sec, recv_names[opts.recv_mode],
+           opts.layout.n_fields, opts.profile);
+    if (opts.recv_mode == RECV_MODE_RING) {
+        printf("%s Receive ring: %zu bytes (%zu messages)\n", info->tag,
+               opts.ring_bytes, opts.ring_bytes / opts.msg_size);
+    }
+    if (opts.recv_mode == RECV_MODE_SPIN) {
+        printf("%s Spin budget: %d µs, then poll()\n", info->tag,
+               opts.spin_us);
+    }
+    if (opts.busy_poll_us > 0) {
+        printf("%s Busy poll: SO_BUSY_POLL %d µs\n", info->tag,
+               opts.busy_poll_us);
+    }
+
+    /* Ignore SIGPIPE */
+    signal(SIGPIPE, SIG_IGN);
+
+    if (opts.numa == NUMA_RR) {
+        printf("%s NUMA: round-robin over %d node(s)\n",
+               info->tag, numa_discover());
+    } else if (opts.numa != NUMA_OFF) {
+        printf("%s NUMA: node %d\n", info->tag, opts.numa);
+    }
+    if (opts.pin != CPU_PIN_NONE || opts.rt_prio > 0) {
+        static const char *const pin_names[] = {
+            "floating", "CPU list", "SO_INCOMING_CPU", "next to SO_INCOMING_CPU"
+        };
+        printf("%s CPU placement: %s", info->tag, pin_names[opts.pin]);
+        if (opts.pin == CPU_PIN_LIST) {
+            printf(" (%d CPUs)", opts.n_cpus);
+        }
+        if (opts.rt_prio > 0) {
+            printf(", SCHED_FIFO %d", opts.rt_prio);
+        }
+        printf("\n");
+    }
+
+    /*
+     * ---- Receive-buffer pool ---------------------------------------------
+     * Map and prefault room for every thread's buffers now, before any
+     * thread starts its clock: a zerocopy thread needs a page-aligned
+     * chunk, and every thread may fall back to a msg_size recv buffer;
+     * scatter / flat also hold a message_t (one 16-byte aligned buffer
+     * per field), ring one ring.  Every buffer also carries a
+     * POOL_HDR_BYTES header.  With --numa each node gets an arena sized
+     * for its own threads.
+     */
+    pool_configure(opts.pool, opts.mlock);
+    if (opts.pool != POOL_MALLOC) {
+        size_t page  = (size_t)sysconf(_SC_PAGESIZE);
+        size_t chunk = (opts.msg_size > ZC_MIN_CHUNK) ? opts.msg_size
+                                                      : ZC_MIN_CHUNK;
+        size_t per_thread = opts.msg_size + 2 * page + chunk +
+                            opts.msg_size +
+                            (size_t)(opts.layout.n_fields + 4) *
+                                (16 + POOL_HDR_BYTES);
+        if (opts.recv_mode == RECV_MODE_RING) {
+            per_thread += opts.ring_bytes;
+        }
+
+        int per_node[NUMA_MAX_NODES] = { 0 };
+        int unplaced = 0;
+        for (int i = 0; i < n_threads; i++) {
+            int node = thread_node(&opts, i);
+            if (node == NUMA_OFF) {
+                unplaced++;
+            } else {
+                per_node[node]++;
+            }
+        }
+        for (int node = NUMA_OFF; node < NUMA_MAX_NODES; node++) {
+            int count = (node == NUMA_OFF) ? unplaced : per_node[node];
+            if (count > 0 &&
+                pool_reserve(per_thread * (size_t)count, node) < 0) {
+                fprintf(stderr, "%s Buffer pool: %s\n", info->tag,
+                        strerror(errno));
+                return EXIT_FAILURE;
+            }
+        }
+        pool_report(info->tag);
+    }
+
+    /* ---- Allocate per-thread structures (all on the heap) ------------- */
+    pthread_t            *tids    = malloc(sizeof(pthread_t)            * n_threads);
+    client_thread_args_t *targs   = malloc(sizeof(client_thread_args_t) * n_threads);
+    thread_result_t      *results = malloc(sizeof(thread_result_t)      * n_threads);
+
+    if (tids == NULL || targs == NULL || results == NULL) {
+        fprintf(stderr, "%s malloc: %s\n", info->tag, strerror(errno));
+        free(tids);
+        free(targs);
+        free(results);
+        return EXIT_FAILURE;
+    }
+
+    /* ---- Launch threads ----------------------------------------------- */
+    for (int i = 0; i < n_threads; i++) {
+        targs[i].opts   = &opts;
+        targs[i].info   = info;
+        targs[i].index  = i;
+        targs[i].node   = thread_node(&opts, i);
+        targs[i].result = &results[i];
+
+        if (pthread_create(&tids[i], NULL, client_thread, &targs[i]) != 0) {
+            fprintf(stderr, "%s pthread_create failed\n", info->tag);
+            memset(&results[i], 0, sizeof(results[i]));
+            tids[i] = 0;
+        }
+    }
+
+    /* ---- Join threads and aggregate results --------------------------- */
+    size_t aggregate_bytes    = 0;
+    size_t aggregate_messages = 0;
+    size_t aggregate_mapped   = 0;
+    size_t aggregate_copied   = 0;
+    size_t aggregate_reads    = 0;
+    size_t aggregate_partial  = 0;
+    size_t aggregate_unpacked = 0;
+    size_t aggregate_hist[RECV_HIST_BUCKETS] = { 0 };
+    size_t aggregate_recvs    = 0;
+    size_t aggregate_polls    = 0;
+    size_t aggregate_dropped  = 0;
+    size_t aggregate_wins     = 0;
+    size_t aggregate_blocks   = 0;
+    double aggregate_cpu_us   = 0.0;
+    uint64_t aggregate_gap_max = 0;
+    size_t aggregate_gaps     = 0;
+    size_t *aggregate_gap     = (size_t *)calloc(GAP_BUCKETS, sizeof(size_t));
+    long   aggregate_nvcsw    = 0;
+    long   aggregate_nivcsw   = 0;
+    double max_elapsed_us     = 0.0;
+
+    for (int i = 0; i < n_threads; i++) {
+        if (tids[i] != 0) {
+            pthread_join(tids[i], NULL);
+        }
+
+        aggregate_bytes    += results[i].total_bytes;
+        aggregate_messages += results[i].total_messages;
+        aggregate_mapped   += results[i].bytes_mapped;
+        aggregate_copied   += results[i].bytes_copied;
+        aggregate_reads    += results[i].reads;
+        aggregate_partial  += results[i].partial_reads;
+        aggregate_unpacked += results[i].bytes_unpacked;
+        for (int b = 0; b < RECV_HIST_BUCKETS; b++) {
+            aggregate_hist[b] += results[i].recv_hist[b];
+            aggregate_recvs   += results[i].recv_hist[b];
+        }
+        aggregate_polls    += results[i].polls;
+        aggregate_dropped  += results[i].bytes_discarded;
+        aggregate_wins     += results[i].spin_wins;
+        aggregate_blocks   += results[i].spin_blocks;
+        aggregate_cpu_us   += results[i].user_us + results[i].sys_us;
+        for (int b = 0; aggregate_gap != NULL && b < GAP_BUCKETS; b++) {
+            aggregate_gap[b] += results[i].gap_hist[b];
+        }
+        aggregate_gaps     += results[i].gap_samples;
+        if (results[i].gap_max_ns > aggregate_gap_max) {
+            aggregate_gap_max = results[i].gap_max_ns;
+        }
+        aggregate_nvcsw    += results[i].nvcsw;
+        aggregate_nivcsw   += results[i].nivcsw;
+
+        if (results[i].elapsed_us > max_elapsed_us) {
+            max_elapsed_us = results[i].elapsed_us;
+        }
+
+        /* Per-thread summary */
+        double thr_s    = results[i].elapsed_us / 1e6;
+        double thr_gbps = (thr_s > 0.0)
+            ? ((double)results[i].total_bytes * 8.0) / (thr_s * 1e9)
+            : 0.0;
+        double avg_lat  = (results[i].total_messages > 0)
+            ? results[i].elapsed_us / (double)results[i].total_messages
+            : 0.0;
+
+        printf("%s Thread %d: %zu bytes, %zu msgs, %.2f s, "
+               "%.4f Gbps, avg latency %.2f µs/msg\n",
+               info->tag, i, results[i].total_bytes,
+               results[i].total_messages, thr_s, thr_gbps, avg_lat);
+        printf("%s Thread %d: %ld voluntary + %ld involuntary context "
+               "switches, %.3f wakeups/msg\n", info->tag, i,
+               results[i].nvcsw, results[i].nivcsw,
+               (results[i].total_messages > 0)
+                   ? (double)results[i].nvcsw /
+                         (double)results[i].total_messages
+                   : 0.0);
+        printf("%s Thread %d: CPU %.2f s user + %.2f s sys (%.0f%% of a "
+               "core)\n", info->tag, i, results[i].user_us / 1e6,
+               results[i].sys_us / 1e6,
+               (results[i].elapsed_us > 0.0)
+                   ? 100.0 * (results[i].user_us + results[i].sys_us) /
+                         results[i].elapsed_us
+                   : 0.0);
+        if (results[i].node != NUMA_OFF && results[i].where[0] != '\0') {
+            printf("%s Thread %d on node %d: buffers %s\n", info->tag, i,
+                   results[i].node, results[i].where);
+        }
+    }
+
+    /* ---- Aggregate summary -------------------------------------------- */
+    double total_s    = max_elapsed_us / 1e6;
+    double agg_gbps   = (total_s > 0.0)
+        ? ((double)aggregate_bytes * 8.0) / (total_s * 1e9)
+        : 0.0;
+    double avg_lat_us = (aggregate_messages > 0)
+        ? max_elapsed_us / (double)aggregate_messages
+        : 0.0;
+
+    if (info->summary != NULL) {
+        printf("\n========== AGGREGATE RESULTS (%s) ==========\n",
+               info->summary);
+    } else {
+        printf("\n========== AGGREGATE RESULTS ==========\n");
+    }
+    printf("Total bytes received : %zu\n", aggregate_bytes);
+    printf("Total messages       : %zu\n", aggregate_messages);
+    printf("Wall-clock time      : %.2f s\n", total_s);
+    printf("Aggregate throughput : %.4f Gbps\n", agg_gbps);
+    printf("Avg latency/msg      : %.2f µs\n", avg_lat_us);
+    if (opts.recv_mode == RECV_MODE_ZEROCOPY) {
+        double pct = (aggregate_bytes > 0)
+            ? 100.0 * (double)aggregate_mapped / (double)aggregate_bytes
+            : 0.0;
+        printf("Bytes mapped (zc)    : %zu (%.1f%%)\n", aggregate_mapped, pct);
+        printf("Bytes copied         : %zu\n", aggregate_copied);
+    }
+    if (opts.recv_mode == RECV_MODE_SCATTER) {
+        printf("recvmsg() calls      : %zu (%zu stopped mid-message)\n",
+               aggregate_reads, aggregate_partial);
+    }
+    if (opts.recv_mode == RECV_MODE_FLAT) {
+        printf("Bytes memcpy'd       : %zu (flat buffer → fields)\n",
+               aggregate_unpacked);
+    }
+    if (opts.recv_mode == RECV_MODE_DISCARD) {
+        printf("Bytes discarded      : %zu (MSG_TRUNC, never copied)\n",
+               aggregate_dropped);
+    }
+    printf("Wakeups/msg          : %.3f (%ld voluntary, %ld involuntary "
+           "context switches)\n",
+           (aggregate_messages > 0)
+               ? (double)aggregate_nvcsw / (double)aggregate_messages
+               : 0.0,
+           aggregate_nvcsw, aggregate_nivcsw);
+    printf("CPU time             : %.2f s (%.0f%% of a core per thread)\n",
+           aggregate_cpu_us / 1e6,
+           (max_elapsed_us > 0.0)
+               ? 100.0 * aggregate_cpu_us / (max_elapsed_us * n_threads)
+               : 0.0);
+    if (aggregate_gaps > 0 && aggregate_gap != NULL) {
+        /* Percentiles of the inter-arrival gap, upper bucket bounds */
+        static const double pct[] = { 50.0, 90.0, 99.0, 99.9 };
+        uint64_t at[4] = { 0 };
+        size_t   seen  = 0;
+        int      p     = 0;
+        for (int b = 0; b < GAP_BUCKETS && p < 4; b++) {
+            seen += aggregate_gap[b];
+            while (p < 4 && (double)seen >=
+                                pct[p] / 100.0 * (double)aggregate_gaps) {
+                at[p++] = gap_bucket_top(b);
+            }
+        }
+        printf("Inter-arrival gaps   : %zu (%.2f msgs per completing read)\n",
+               aggregate_gaps,
+               (double)aggregate_messages / (double)aggregate_gaps);
+        printf("Gap p50/p90/p99      : %.2f / %.2f / %.2f µs\n",
+               (double)at[0] / 1e3, (double)at[1] / 1e3, (double)at[2] / 1e3);
+        printf("Gap p99.9/max        : %.2f / %.2f µs\n",
+               (double)at[3] / 1e3, (double)aggregate_gap_max / 1e3);
+    }
+    if (opts.recv_mode == RECV_MODE_SPIN) {
+        size_t waits = aggregate_wins + aggregate_blocks;
+        printf("Spin waits           : %zu (%.1f%% ended by data, the rest "
+               "in poll())\n", waits,
+               (waits > 0) ? 100.0 * (double)aggregate_wins / (double)waits
+                           : 0.0);
+    }
+    if (opts.recv_mode == RECV_MODE_LOWAT) {
+        printf("poll() wakeups       : %zu (%.3f per msg)\n", aggregate_polls,
+               (aggregate_messages > 0)
+                   ? (double)aggregate_polls / (double)aggregate_messages
+                   : 0.0);
+    }
+    if (aggregate_recvs > 0) {
+        /* How much the kernel coalesced: bytes per recv() */
+        printf("recv() calls         : %zu (%.1f bytes/call, %.3f "
+               "calls/msg)\n", aggregate_recvs,
+               (double)aggregate_bytes / (double)aggregate_recvs,
+               (aggregate_messages > 0)
+                   ? (double)aggregate_recvs / (double)aggregate_messages
+                   : 0.0);
+        for (int b = 0; b < RECV_HIST_BUCKETS; b++) {
+            if (aggregate_hist[b] == 0) {
+                continue;
+            }
+            printf("  recv() %8zu B+   : %12zu (%5.1f%%)\n",
+                   (size_t)1 << b, aggregate_hist[b],
+                   100.0 * (double)aggregate_hist[b] /
+                       (double)aggregate_recvs);
+        }
+    }
+
+    /* Final placement, in --cpus LIST form, to reproduce a good run */
+    printf("Thread CPUs (final)  :");
+    for (int i = 0; i < n_threads; i++) {
+        printf("%s%d", (i > 0) ? "," : " ", results[i].final_cpu);
+    }
+    printf("\nRx CPUs (softirq)    :");
+    for (int i = 0; i < n_threads; i++) {
+        printf("%s%d", (i > 0) ? "," : " ", results[i].rx_cpu);
+    }
+    printf("\n");
+    printf("========================================================\n");
+
+    /* ---- Cleanup ------------------------------------------------------ */
+    free(tids);
+    free(targs);
+    free(results);
+    free(aggregate_gap);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_client.h
+// Purpose: Shared client runtime for PA02.
+//
+//          The A1–A5 clients only differ in their log tag and banner; the
+//          connect / receive / report logic lives here once.  Every client
+//          thread opens its own TCP connection, receives for a fixed
+//          duration with the selected receive engine, and the main thread
+//          prints per-thread and aggregate results in the format parsed by
+//          MT25082_run_experiments.sh.
+//
+//          Receive engines (--recv):
+//
+//            copy     – recv() into a private heap buffer (the original
+//                       PA02 path; one kernel→user copy per byte).
+//            zerocopy – TCP_ZEROCOPY_RECEIVE: page-aligned payload is
+//                       mapped into a PROT_READ mmap() of the socket
+//                       instead of copied; only the unaligned remainder
+//                       is copied with recv().
+//            scatter  – recvmsg() straight into the fields of a message_t
+//                       laid out like the server's (--nfields/--profile),
+//                       one iovec entry per field.
+//            flat     – recv() into a flat buffer, then memcpy() every
+//                       complete message into the fields of a message_t
+//                       (what a consumer without vectored reads does).
+//            ring     – recv() as much as fits into a large ring (--ring
+//                       bytes) and split messages out of it in place, so
+//                       the kernel may coalesce many small messages into
+//                       one call.
+//            waitall  – recv(MSG_WAITALL): one whole message per call.
+//            lowat    – SO_RCVLOWAT = msg_size and poll(), so the thread
+//                       is only woken once a whole message is queued.
+//            discard  – recv(NULL, MSG_TRUNC): TCP drops the bytes without
+//                       copying them to user space, so comparing its
+//                       cycles with copy's isolates the receive copy.
+//            spin     – non-blocking recv() in a loop; after --spin µs
+//                       without data the thread blocks in poll() instead.
+//
+//          --busy-poll USEC sets SO_BUSY_POLL (and SO_PREFER_BUSY_POLL) on
+//          every socket, so a blocking read polls the NIC queue itself
+//          for up to USEC µs before it sleeps; it combines with any engine.
+//
+//          The recv()-based engines also report the distribution of bytes
+//          returned per recv() call, and every engine reports its threads'
+//          context switches (voluntary ones = wakeups) per message, CPU
+//          time and percentiles of the inter-arrival gap between reads
+//          that complete a message (not a latency: messages carry no
+//          send timestamp).
+//
+// Usage (every MT25082_Part_A*_Client):
+//   ./MT25082_Part_AN_Client [options]
+//       <server_ip> <port> <msg_size> <threads> <duration>
+//
+//   -r, --recv ENGINE        copy (default) | zerocopy | scatter | flat |
+//                            ring | waitall | lowat | discard | spin
+//   -b, --ring BYTES         ring size for --recv ring
+//   -S, --spin USEC          spin budget before poll() for --recv spin
+//   -B, --busy-poll USEC     SO_BUSY_POLL (+ SO_PREFER_BUSY_POLL)
+//   -n, --nfields N          fields per message, as given to the server
+//   -p, --profile P          field sizes, as given to the server
+//   -P, --pool TYPE          receive-buffer memory: malloc | thp | hugetlb
+//   -L, --mlock              mlock() the --pool arenas
+//   -N, --numa rr|NODE       per-thread NUMA node for thread, socket and
+//                            buffers
+//   -c, --cpus LIST|rx|rx-next
+//                            pin thread i to a CPU of LIST, or to the
+//                            socket's RX CPU (rx) or its neighbour
+//   -R, --rt PRIO            SCHED_FIFO receive threads
+//
+//   Defaults and limits are printed on any unknown option (usage() in
+//   MT25082_client.c).
+// =============================================================================
+
+#ifndef MT25082_CLIENT_H
+#define MT25082_CLIENT_H
+
+#include "MT25082_common.h"
+
+// ===========================================================================
+//  Data Structures
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  recv_mode_t
+//  -----------
+//  Receive engine selected at startup with --recv.
+// ---------------------------------------------------------------------------
+typedef enum {
+    RECV_MODE_COPY = 0,         /* recv() into a heap buffer                 */
+    RECV_MODE_ZEROCOPY,         /* TCP_ZEROCOPY_RECEIVE + recv() fallback    */
+    RECV_MODE_SCATTER,          /* recvmsg() into message_t fields           */
+    RECV_MODE_FLAT,             /* recv() + memcpy() into message_t fields   */
+    RECV_MODE_RING,             /* recv() into a large ring, split in place  */
+    RECV_MODE_WAITALL,          /* recv(MSG_WAITALL), one message per call   */
+    RECV_MODE_LOWAT,            /* SO_RCVLOWAT + poll(), then recv()         */
+    RECV_MODE_DISCARD,          /* recv(MSG_TRUNC): drained, never copied    */
+    RECV_MODE_SPIN              /* Spin on MSG_DONTWAIT, then poll()         */
+} recv_mode_t;
+
+// ---------------------------------------------------------------------------
+//  client_opts_t
+//  -------------
+//  Parsed command line, shared read-only by every client thread.
+// ---------------------------------------------------------------------------
+typedef struct {
+    char        server_ip[64];  /* Server IP address string                  */
+    int         port;           /* Server port number                        */
+    size_t      msg_size;       /* Expected total message size (bytes)       */
+    int         n_threads;      /* Concurrent connections                    */
+    int         duration_sec;   /* How long to receive (seconds)             */
+    recv_mode_t recv_mode;      /* Receive engine                            */
+    const char *profile;        /* --profile as given (for reports)          */
+    msg_layout_t layout;        /* Field layout the server sends             */
+    pool_type_t  pool;          /* Receive-buffer memory (--pool)            */
+    bool         mlock;         /* mlock() the pool arenas (--mlock)         */
+    int          numa;          /* NUMA_OFF, NUMA_RR or a node (--numa)      */
+    cpu_pin_t    pin;           /* Thread placement (--cpus)                 */
+    int          n_cpus;        /* Entries in cpus[] (CPU_PIN_LIST)          */
+    int          cpus[MAX_CPUS]; /* Thread i on cpus[i % n_cpus]             */
+    int          rt_prio;       /* SCHED_FIFO priority, 0 = off (--rt)       */
+    size_t       ring_bytes;    /* Ring size, a multiple of msg_size (--ring)*/
+    int          spin_us;       /* Spin budget before poll() (--spin)        */
+    int          busy_poll_us;  /* SO_BUSY_POLL, 0 = off (--busy-poll)       */
+} client_opts_t;
+
+// ---------------------------------------------------------------------------
+//  client_info_t
+//  -------------
+//  Per-client identity.  Each client file provides one static instance.
+//
+//  Members:
+//      tag     – log prefix, e.g. "[Client-A2]"
+//      banner  – one-line description printed at startup
+//      summary – title of the aggregate results block, e.g. "A2 — One-Copy"
+//                (NULL prints a plain "AGGREGATE RESULTS" header)
+// ---------------------------------------------------------------------------
+typedef struct {
+    const char *tag;
+    const char *banner;
+    const char *summary;
+} client_info_t;
+
+// ===========================================================================
+//  Function Declarations
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  client_main
+//  -----------
+//  Complete client entry point: parses
+//      <prog> [--recv copy|zerocopy|scatter|flat|ring|waitall|lowat|discard|
+//                     spin] [--ring BYTES] [--spin USEC] [--busy-poll USEC]
+//             [--nfields N] [--profile P]
+//             [--pool malloc|thp|hugetlb] [--mlock] [--numa rr|NODE]
+//             [--cpus LIST|rx|rx-next] [--rt PRIO]
+//             <server_ip> <port> <msg_size> <threads> <duration_sec>
+//  runs the client threads and prints the results.
+//
+//  Returns:
+//      EXIT_SUCCESS or EXIT_FAILURE, suitable for returning from main().
+// ---------------------------------------------------------------------------
+int client_main(int argc, char *argv[], const client_info_t *info);
+
+#endif /* MT25082_CLIENT_H */
@@ -8,7 +8,8 @@
 //          zero-copy).
 //
 // Design notes:
-//   • Every message field is individually heap-allocated with malloc().
+//   • Every message field is individually heap-allocated with malloc()
+//     (or, with --alloc, carved from one aligned heap block).
 //     Heap allocation is used (rather than stack or static buffers) because:
 //       1. Message sizes are determined at runtime (parameterized).
 //       2. Each thread gets its own independent buffers, avoiding shared
@@ -22,16 +23,139 @@
 //     threads are safe without locks.
 // =============================================================================
 
+#define _GNU_SOURCE             /* cpu_set_t, pthread_setaffinity_np         */
+
 #include "MT25082_common.h"
 
+#include <sched.h>              /* CPU_ZERO, CPU_SET, SCHED_FIFO             */
+#include <stddef.h>             /* offsetof                                  */
+#include <stdint.h>             /* uint32_t, uint64_t                        */
+#include <sys/resource.h>       /* getrusage, RUSAGE_THREAD                  */
+
+// ===========================================================================
+//  message_layout
+// ===========================================================================
+//  The profiles model the message schemas we care about: equal fields
+//  (the original PA02 layout), a few small headers in front of one bulk
+//  payload, and a spread of sizes where most bytes sit in a few fields.
+// ---------------------------------------------------------------------------
+static int parse_layout_list(msg_layout_t *layout, size_t msg_size,
+                             const char *str)
+{
+    const char *p    = str;
+    int         n    = 0;
+    int         star = -1;
+    size_t      sum  = 0;
+
+    for (;;) {
+        if (n == MAX_FIELDS) {
+            return -1;
+        }
+        if (*p == '*') {
+            if (star >= 0) {
+                return -1;      /* Only one field may take the rest */
+            }
+            star            = n;
+            layout->size[n] = 0;
+            p++;
+        } else {
+            char *end;
+            errno = 0;
+            unsigned long long v = strtoull(p, &end, 10);
+            if (end == p || errno != 0 || *p == '-') {
+                return -1;
+            }
+            layout->size[n] = (size_t)v;
+            sum            += layout->size[n];
+            p               = end;
+        }
+        n++;
+
+        if (*p == '\0') {
+            break;
+        }
+        if (*p != ',') {
+            return -1;
+        }
+        p++;
+    }
+
+    if (star >= 0) {
+        if (sum > msg_size) {
+            return -1;
+        }
+        layout->size[star] = msg_size - sum;
+        sum                = msg_size;
+    }
+    layout->n_fields = n;
+    return (sum == msg_size) ? 0 : -1;
+}
+
+int message_layout(msg_layout_t *layout, size_t msg_size, int n_fields,
+                   const char *profile)
+{
+    if (profile == NULL) {
+        profile = "uniform";
+    }
+
+    /* ---- Explicit list: its length is the field count ----------------- */
+    if (strchr(profile, ',') != NULL || strchr(profile, '*') != NULL ||
+        (profile[0] >= '0' && profile[0] <= '9')) {
+        if (parse_layout_list(layout, msg_size, profile) < 0) {
+            return -1;
+        }
+        return (n_fields == 0 || n_fields == layout->n_fields) ? 0 : -1;
+    }
+
+    if (n_fields == 0) {
+        n_fields = NUM_FIELDS;
+    }
+    if (n_fields < 1 || n_fields > MAX_FIELDS) {
+        return -1;
+    }
+    layout->n_fields = n_fields;
+
+    size_t left = msg_size;
+    int    last = n_fields - 1;
+
+    if (strcmp(profile, "uniform") == 0) {
+        /*
+         * If msg_size is not evenly divisible by n_fields, the last field
+         * absorbs the remainder so that the total equals msg_size exactly.
+         */
+        for (int i = 0; i < last; i++) {
+            layout->size[i] = msg_size / (size_t)n_fields;
+        }
+    } else if (strcmp(profile, "skewed") == 0) {
+        size_t small = SKEW_SMALL_BYTES;
+        if (last > 0 && small * (size_t)last > msg_size / 2) {
+            small = msg_size / 2 / (size_t)last;
+        }
+        for (int i = 0; i < last; i++) {
+            layout->size[i] = small;
+        }
+    } else if (strcmp(profile, "geometric") == 0) {
+        for (int i = 0; i < last; i++) {
+            layout->size[i] = left / 2;
+            left           -= left / 2;
+        }
+        layout->size[last] = left;
+        return 0;
+    } else {
+        return -1;
+    }
+
+    for (int i = 0; i < last; i++) {
+        left -= layout->size[i];
+    }
+    layout->size[last] = left;
+    return 0;
+}
+
 // ===========================================================================
 //  allocate_message
 // ===========================================================================
-//  Allocates 8 separate heap buffers for the fields of *msg.
-//
-//  Each buffer receives (msg_size / NUM_FIELDS) bytes.  If msg_size is not
-//  evenly divisible by 8, the last field absorbs the remainder so that the
-//  total allocated memory equals msg_size exactly.
+//  Allocates one separate heap buffer per field of *msg.
 //
 //  Why heap allocation?
 //  --------------------
@@ -43,43 +167,185 @@
 //    having them on the heap faithfully represents the data-movement
 //    cost we want to measure.
 // ---------------------------------------------------------------------------
-void allocate_message(message_t *msg, size_t msg_size)
+void allocate_message(message_t *msg, const msg_layout_t *layout)
 {
-    /* Guard against NULL pointer or zero-size request */
-    if (msg == NULL || msg_size == 0) {
-        fprintf(stderr, "[allocate_message] ERROR: NULL msg or zero size\n");
+    allocate_message_aligned(msg, layout, 0);
+}
+
+// ===========================================================================
+//  allocate_message_aligned
+// ===========================================================================
+//  Allocates field i with layout->size[i] bytes (at least 1, so every
+//  field has a pointer free_message() can release), starting on an
+//  `align`-byte boundary; align == 0 means malloc()'s alignment.  The
+//  buffers come from pool_alloc(): plain malloc() / posix_memalign()
+//  unless --pool selected huge-page arenas.
+// ---------------------------------------------------------------------------
+void allocate_message_aligned(message_t *msg, const msg_layout_t *layout,
+                              size_t align)
+{
+    /* Guard against NULL pointers */
+    if (msg == NULL || layout == NULL) {
+        fprintf(stderr, "[allocate_message] ERROR: NULL msg or layout\n");
         return;
     }
 
-    /* Base size for each of the 8 fields */
-    size_t per_field = msg_size / NUM_FIELDS;
-
-    /* Remainder bytes that don't divide evenly into 8 */
-    size_t remainder = msg_size % NUM_FIELDS;
+    msg->n_fields = 0;
+    msg->block    = NULL;
+    msg->field    = (char **)calloc((size_t)layout->n_fields, sizeof(char *));
+    if (msg->field == NULL) {
+        perror("[allocate_message] malloc failed");
+        return;
+    }
 
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        /*
-         * The last field picks up any leftover bytes so the total
-         * allocation sums to exactly msg_size.
-         */
-        size_t alloc_size = per_field + ((i == NUM_FIELDS - 1) ? remainder : 0);
+    for (int i = 0; i < layout->n_fields; i++) {
+        size_t alloc_size = layout->size[i];
 
-        msg->field[i] = (char *)malloc(alloc_size);
+        msg->field[i] = (char *)pool_alloc(alloc_size, align);
 
         if (msg->field[i] == NULL) {
             perror("[allocate_message] malloc failed");
 
             /* Roll back any fields already allocated to prevent leaks */
             for (int j = 0; j < i; j++) {
-                free(msg->field[j]);
-                msg->field[j] = NULL;
+                pool_free(msg->field[j]);
             }
+            free(msg->field);
+            msg->field = NULL;
             return;
         }
 
         /* Zero-initialise to avoid valgrind/undefined-behaviour warnings */
         memset(msg->field[i], 0, alloc_size);
     }
+    msg->n_fields = layout->n_fields;
+}
+
+// ===========================================================================
+//  allocate_message_block
+// ===========================================================================
+//  One pool_alloc() for the whole message: the field offsets are laid
+//  out first, padding each field start up to `align`, then the fields are
+//  pointed into the block.  Small fields no longer share cache lines with
+//  allocator metadata, and walking the message walks one region.
+// ---------------------------------------------------------------------------
+void allocate_message_block(message_t *msg, const msg_layout_t *layout,
+                            size_t align)
+{
+    if (msg == NULL || layout == NULL) {
+        fprintf(stderr, "[allocate_message] ERROR: NULL msg or layout\n");
+        return;
+    }
+    if (align == 0) {
+        align = 1;
+    }
+
+    msg->n_fields = 0;
+    msg->block    = NULL;
+    msg->field    = (char **)calloc((size_t)layout->n_fields, sizeof(char *));
+    if (msg->field == NULL) {
+        perror("[allocate_message] malloc failed");
+        return;
+    }
+
+    size_t total = 0;
+    for (int i = 0; i < layout->n_fields; i++) {
+        total  = (total + align - 1) & ~(align - 1);
+        total += layout->size[i];
+    }
+
+    size_t block_align = (align > CACHE_LINE_SIZE) ? align : CACHE_LINE_SIZE;
+    msg->block = (char *)pool_alloc(total, block_align);
+    if (msg->block == NULL) {
+        perror("[allocate_message] malloc failed");
+        free(msg->field);
+        msg->field = NULL;
+        return;
+    }
+    memset(msg->block, 0, total);
+
+    size_t off = 0;
+    for (int i = 0; i < layout->n_fields; i++) {
+        off           = (off + align - 1) & ~(align - 1);
+        msg->field[i] = msg->block + off;
+        off          += layout->size[i];
+    }
+    msg->n_fields = layout->n_fields;
+}
+
+// ===========================================================================
+//  allocate_message_as
+// ===========================================================================
+void allocate_message_as(message_t *msg, const msg_layout_t *layout,
+                         msg_alloc_t alloc)
+{
+    switch (alloc) {
+    case MSG_ALLOC_PACKED:
+        allocate_message_block(msg, layout, 1);
+        break;
+    case MSG_ALLOC_LINE:
+        allocate_message_block(msg, layout, CACHE_LINE_SIZE);
+        break;
+    case MSG_ALLOC_PAGE:
+        allocate_message_block(msg, layout, (size_t)sysconf(_SC_PAGESIZE));
+        break;
+    default:
+        allocate_message(msg, layout);
+        break;
+    }
+}
+
+// ===========================================================================
+//  parse_msg_alloc / msg_alloc_name
+// ===========================================================================
+static const char *const msg_alloc_names[] = {
+    "scatter", "packed", "line", "page"
+};
+
+int parse_msg_alloc(const char *str, msg_alloc_t *alloc)
+{
+    for (int i = 0; i <= MSG_ALLOC_PAGE; i++) {
+        if (strcmp(str, msg_alloc_names[i]) == 0) {
+            *alloc = (msg_alloc_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *msg_alloc_name(msg_alloc_t alloc)
+{
+    return msg_alloc_names[alloc];
+}
+
+// ===========================================================================
+//  message_iov
+// ===========================================================================
+//  Merging is limited to single-block messages: separately malloc'd
+//  fields are never adjacent in practice, and only inside one block is
+//  the result guaranteed to be the same for every message.
+// ---------------------------------------------------------------------------
+int message_iov(const message_t *msg, const msg_layout_t *layout,
+                int first, int n, struct iovec *iov)
+{
+    int cnt = 0;
+
+    for (int i = first; i < first + n; i++) {
+        size_t len = layout->size[i];
+        if (len == 0) {
+            continue;
+        }
+        if (cnt > 0 && msg->block != NULL &&
+            (char *)iov[cnt - 1].iov_base + iov[cnt - 1].iov_len ==
+                msg->field[i]) {
+            iov[cnt - 1].iov_len += len;
+            continue;
+        }
+        iov[cnt].iov_base = msg->field[i];
+        iov[cnt].iov_len  = len;
+        cnt++;
+    }
+    return cnt;
 }
 
 // ===========================================================================
@@ -94,55 +360,50 @@ void allocate_message(message_t *msg, size_t msg_size)
 //  receiving side and ensures reproducible cache / memory-access patterns
 //  across experiment runs.
 // ---------------------------------------------------------------------------
-void fill_message(message_t *msg, size_t msg_size)
+void fill_message(message_t *msg, const msg_layout_t *layout)
 {
-    if (msg == NULL || msg_size == 0) {
+    if (msg == NULL || msg->field == NULL) {
         return;
     }
 
-    size_t per_field = msg_size / NUM_FIELDS;
-    size_t remainder = msg_size % NUM_FIELDS;
-
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        /* Skip fields that were never allocated */
-        if (msg->field[i] == NULL) {
-            continue;
-        }
-
-        /* Determine the actual size of this field's buffer */
-        size_t field_size = per_field + ((i == NUM_FIELDS - 1) ? remainder : 0);
-
+    for (int i = 0; i < msg->n_fields; i++) {
         /*
          * Fill with a repeating character unique to this field index.
          * memset is used here for speed — it is typically implemented
          * with optimised SIMD instructions on modern platforms.
          */
         char fill_char = 'A' + (i % 26);
-        memset(msg->field[i], fill_char, field_size);
+        memset(msg->field[i], fill_char, layout->size[i]);
     }
 }
 
 // ===========================================================================
 //  free_message
 // ===========================================================================
-//  Safely frees all 8 heap-allocated field buffers in *msg.
+//  Safely frees every heap-allocated field buffer in *msg, then the field
+//  table.
 //
-//  After freeing, each pointer is set to NULL.  This prevents:
+//  After freeing, the pointers are set to NULL.  This prevents:
 //    • Double-free errors if free_message() is accidentally called twice.
 //    • Dangling-pointer dereferences in subsequent code.
 // ---------------------------------------------------------------------------
 void free_message(message_t *msg)
 {
-    if (msg == NULL) {
+    if (msg == NULL || msg->field == NULL) {
         return;
     }
 
-    for (int i = 0; i < NUM_FIELDS; i++) {
-        if (msg->field[i] != NULL) {
-            free(msg->field[i]);
-            msg->field[i] = NULL;   /* Prevent dangling pointer / double-free */
+    if (msg->block != NULL) {
+        pool_free(msg->block);  /* Every field points into the block */
+    } else {
+        for (int i = 0; i < msg->n_fields; i++) {
+            pool_free(msg->field[i]);
         }
     }
+    free(msg->field);
+    msg->field    = NULL;       /* Prevent dangling pointer / double-free */
+    msg->block    = NULL;
+    msg->n_fields = 0;
 }
 
 // ===========================================================================
@@ -178,3 +439,258 @@ double get_time_us(void)
      */
     return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
 }
+
+// ===========================================================================
+//  iov_tail
+// ===========================================================================
+//  Skips whole entries that were fully sent, trims the first partially
+//  sent entry, and copies the untouched entries verbatim.  The source
+//  iovec is never modified, so the pre-registered array can be reused for
+//  the next message.
+// ---------------------------------------------------------------------------
+int iov_tail(const struct iovec *iov, int iovcnt, size_t skip,
+             struct iovec *out)
+{
+    int n = 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        if (skip >= iov[i].iov_len) {
+            skip -= iov[i].iov_len;     /* Entry already fully sent */
+            continue;
+        }
+
+        out[n].iov_base = (char *)iov[i].iov_base + skip;
+        out[n].iov_len  = iov[i].iov_len - skip;
+        skip = 0;
+        n++;
+    }
+
+    return n;
+}
+
+// ===========================================================================
+//  iov_cursor_start
+// ===========================================================================
+void iov_cursor_start(iov_cursor_t *cur, struct iovec *iov, int iovcnt,
+                      size_t msg_size)
+{
+    cur->iov       = iov;
+    cur->iovcnt    = iovcnt;
+    cur->remaining = 0;
+    cur->msg_size  = msg_size;
+    cur->msg_off   = 0;
+    for (int i = 0; i < iovcnt; i++) {
+        cur->remaining += iov[i].iov_len;
+    }
+    if (iovcnt > 0) {
+        cur->saved = iov[0];
+    }
+}
+
+// ===========================================================================
+//  iov_cursor_advance
+// ===========================================================================
+//  Only the head entry is ever modified, and its registered value is kept
+//  in `saved`, so restoring it is a single store when the cursor moves on.
+//  Zero-length entries are stepped over as soon as they reach the head.
+// ---------------------------------------------------------------------------
+size_t iov_cursor_advance(iov_cursor_t *cur, size_t n)
+{
+    size_t done = 0;
+
+    cur->writes++;
+    if (n < cur->remaining) {
+        cur->partial_writes++;
+    }
+    cur->remaining -= n;
+
+    if (cur->msg_size > 0) {
+        cur->msg_off += n;
+        done          = cur->msg_off / cur->msg_size;
+        cur->msg_off %= cur->msg_size;
+    }
+
+    while (cur->iovcnt > 0 && n >= cur->iov->iov_len) {
+        n -= cur->iov->iov_len;
+        *cur->iov = cur->saved;         /* Entry fully sent — restore it */
+        cur->iov++;
+        if (--cur->iovcnt > 0) {
+            cur->saved = *cur->iov;
+        }
+    }
+    if (n > 0) {
+        cur->iov->iov_base = (char *)cur->iov->iov_base + n;
+        cur->iov->iov_len -= n;
+    }
+
+    return done;
+}
+
+// ===========================================================================
+//  parse_cpu_list
+// ===========================================================================
+//  Accepts comma-separated single CPUs and inclusive "lo-hi" ranges.
+// ---------------------------------------------------------------------------
+int parse_cpu_list(const char *str, int *cpus, int max)
+{
+    int n = 0;
+    const char *p = str;
+
+    while (*p != '\0') {
+        char *end;
+        long lo = strtol(p, &end, 10);
+        if (end == p || lo < 0) {
+            return -1;
+        }
+
+        long hi = lo;
+        if (*end == '-') {
+            p  = end + 1;
+            hi = strtol(p, &end, 10);
+            if (end == p || hi < lo) {
+                return -1;
+            }
+        }
+
+        for (long cpu = lo; cpu <= hi; cpu++) {
+            if (n == max) {
+                return -1;
+            }
+            cpus[n++] = (int)cpu;
+        }
+
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return -1;
+        }
+        p = end;
+    }
+
+    return (n > 0) ? n : -1;
+}
+
+// ===========================================================================
+//  pin_thread_to_cpu
+// ===========================================================================
+int pin_thread_to_cpu(int cpu)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+// ===========================================================================
+//  parse_cpu_pin
+// ===========================================================================
+int parse_cpu_pin(const char *str, cpu_pin_t *pin, int *cpus, int max)
+{
+    if (strcmp(str, "rx") == 0) {
+        *pin = CPU_PIN_RX;
+        return 0;
+    }
+    if (strcmp(str, "rx-next") == 0) {
+        *pin = CPU_PIN_RX_NEXT;
+        return 0;
+    }
+    *pin = CPU_PIN_LIST;
+    return parse_cpu_list(str, cpus, max);
+}
+
+// ===========================================================================
+//  socket_rx_cpu / rx_pin_cpu
+// ===========================================================================
+int socket_rx_cpu(int fd)
+{
+    int       cpu = -1;
+    socklen_t len = sizeof(cpu);
+    if (getsockopt(fd, SOL_SOCKET, SO_INCOMING_CPU, &cpu, &len) < 0) {
+        return -1;
+    }
+    return cpu;
+}
+
+int rx_pin_cpu(int rx_cpu, cpu_pin_t pin)
+{
+    if (rx_cpu < 0 || pin != CPU_PIN_RX_NEXT) {
+        return rx_cpu;
+    }
+    return numa_next_cpu(rx_cpu);
+}
+
+// ===========================================================================
+//  set_thread_fifo
+// ===========================================================================
+int set_thread_fifo(int prio)
+{
+    struct sched_param sp;
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = prio;
+
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+// ===========================================================================
+//  get_thread_cpu_s
+// ===========================================================================
+double get_thread_cpu_s(void)
+{
+    struct rusage ru;
+    if (getrusage(RUSAGE_THREAD, &ru) < 0) {
+        return 0.0;
+    }
+    return (double)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           (double)(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+// ===========================================================================
+//  get_tcp_data_segs_out
+// ===========================================================================
+//  glibc's struct tcp_info stops at tcpi_total_retrans; the kernel's has
+//  grown since, and <linux/tcp.h> clashes with <netinet/tcp.h>.  The tail
+//  up to tcpi_data_segs_out is therefore spelled out here, in kernel
+//  order.  A kernel that does not know the counter returns a shorter
+//  optlen, which is reported as "not available".
+// ---------------------------------------------------------------------------
+typedef struct {
+    struct tcp_info base;
+    uint64_t        pacing_rate;
+    uint64_t        max_pacing_rate;
+    uint64_t        bytes_acked;
+    uint64_t        bytes_received;
+    uint32_t        segs_out;
+    uint32_t        segs_in;
+    uint32_t        notsent_bytes;
+    uint32_t        min_rtt;
+    uint32_t        data_segs_in;
+    uint32_t        data_segs_out;
+} tcp_info_ext_t;
+
+int get_tcp_data_segs_out(int fd, size_t *segs)
+{
+    tcp_info_ext_t info;
+    socklen_t len = sizeof(info);
+
+    memset(&info, 0, sizeof(info));
+    if (getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &len) < 0) {
+        return -1;
+    }
+    if (len < offsetof(tcp_info_ext_t, data_segs_out) +
+              sizeof(info.data_segs_out)) {
+        return -1;
+    }
+    *segs = info.data_segs_out;
+    return 0;
+}
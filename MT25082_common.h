@@ -54,12 +54,21 @@
 // ---------------------------------------------------------------------------
 #include <stdbool.h>            /* bool, true, false                         */
 
+// ---------------------------------------------------------------------------
+//  Buffer pool (message / receive buffers, optionally on huge pages)
+// ---------------------------------------------------------------------------
+#include "MT25082_pool.h"       /* pool_alloc, pool_free, --pool             */
+#include "MT25082_numa.h"       /* numa_pick, numa_bind_memory, --numa       */
+
 // ===========================================================================
 //  Constants
 // ===========================================================================
 
-#define NUM_FIELDS         8    /* Number of dynamically allocated string     */
-                               /* fields inside message_t.                   */
+#define NUM_FIELDS         8    /* Default number of dynamically allocated    */
+                               /* string fields inside message_t.            */
+
+#define MAX_FIELDS         1024 /* Most fields a message may have: each is    */
+                               /* one iovec entry, so IOV_MAX on Linux.      */
 
 #define DEFAULT_PORT       9090 /* Default TCP port for client–server comms.  */
 
@@ -67,25 +76,70 @@
 
 #define BACKLOG            64   /* listen() backlog queue size.               */
 
+#define MAX_CPUS           1024 /* Upper bound on entries in a CPU list.      */
+
+#define SKEW_SMALL_BYTES   16   /* Header field size of the "skewed" profile. */
+
+#define CACHE_LINE_SIZE    64   /* Field alignment of --alloc line.           */
+
 // ===========================================================================
 //  Data Structures
 // ===========================================================================
 
+// ---------------------------------------------------------------------------
+//  msg_layout_t
+//  ------------
+//  How a message is split into fields: the field count and the size of
+//  every field.  Built once at startup by message_layout() from --nfields
+//  and --profile, then shared read-only by every connection.
+//
+//  Members:
+//      n_fields – number of fields (1..MAX_FIELDS); NUM_FIELDS by default
+//      size[i]  – bytes in field i (may be 0); they add up to msg_size
+// ---------------------------------------------------------------------------
+typedef struct {
+    int    n_fields;            /* Fields per message                        */
+    size_t size[MAX_FIELDS];    /* Bytes per field                           */
+} msg_layout_t;
+
+// ---------------------------------------------------------------------------
+//  msg_alloc_t
+//  -----------
+//  Where the fields of a message live, selected at startup with --alloc.
+//  The single-block variants put every field in one allocation, so a
+//  message touches one contiguous region instead of n_fields scattered
+//  heap chunks, and fields that end up adjacent share one iovec entry
+//  (see message_iov()).
+// ---------------------------------------------------------------------------
+typedef enum {
+    MSG_ALLOC_SCATTER = 0,      /* One malloc() per field (original PA02)    */
+    MSG_ALLOC_PACKED,           /* One block, fields back to back            */
+    MSG_ALLOC_LINE,             /* One block, fields on cache-line bounds    */
+    MSG_ALLOC_PAGE              /* One block, fields on page boundaries      */
+} msg_alloc_t;
+
 // ---------------------------------------------------------------------------
 //  message_t
 //  ---------
-//  Represents a single network message composed of exactly 8 dynamically
-//  allocated string fields.  Each field points to a heap buffer whose size
-//  is determined at runtime (msg_size / NUM_FIELDS bytes per field).
+//  Represents a single network message composed of n_fields dynamically
+//  allocated string fields (8 by default).  Each field points to a heap
+//  buffer whose size is given by the msg_layout_t it was allocated with.
 //
-//  Memory layout (after allocation):
+//  Memory layout (after allocation, default uniform layout):
 //      field[0] -> malloc'd buffer of (msg_size / 8) bytes
 //      field[1] -> malloc'd buffer of (msg_size / 8) bytes
 //      ...
 //      field[7] -> malloc'd buffer of (msg_size / 8) bytes
+//
+//  With a single-block allocation the fields instead point into `block`:
+//      block -> | field[0] | pad | field[1] | pad | ... | field[7] |
+//  where each pad rounds the next field up to the block's alignment.
 // ---------------------------------------------------------------------------
 typedef struct {
-    char *field[NUM_FIELDS];    /* 8 dynamically allocated string buffers    */
+    int    n_fields;            /* Number of fields                          */
+    char **field;               /* n_fields dynamically allocated buffers    */
+    char  *block;               /* Single allocation holding every field,    */
+                                /* or NULL if each field was malloc'd        */
 } message_t;
 
 // ---------------------------------------------------------------------------
@@ -105,28 +159,171 @@ typedef struct {
     int    duration_sec;        /* Duration of continuous transfer (seconds) */
 } thread_args_t;
 
+// ---------------------------------------------------------------------------
+//  iov_cursor_t
+//  ------------
+//  Send position inside a pre-registered iovec span (one message, a batch
+//  of messages, or one run of fields).  A short send is resumed by
+//  trimming the first unsent entry IN PLACE — nothing is copied — and the
+//  entry is restored as soon as it has been sent in full, so the caller's
+//  array is intact again once the span completes.
+//
+//  The span's entries must not be read by anyone else while it is being
+//  sent (e.g. by in-flight io_uring requests); such callers use iov_tail().
+//
+//  Members:
+//      iov, iovcnt    – first unsent entry and entries left (pass these
+//                       to sendmsg() / writev())
+//      remaining      – bytes of the span not yet sent
+//      msg_size       – message length for boundary tracking (0 = none)
+//      msg_off        – bytes of the current message already sent
+//      writes         – sends accounted with iov_cursor_advance()
+//      partial_writes – ...of which left part of the span unsent
+//
+//  The counters accumulate across spans; zero the cursor once before use.
+// ---------------------------------------------------------------------------
+typedef struct {
+    struct iovec *iov;          /* First unsent entry (in caller's array)    */
+    int           iovcnt;       /* Entries left, including *iov             */
+    struct iovec  saved;        /* *iov as registered, before trimming       */
+    size_t        remaining;    /* Bytes of the span still to send           */
+    size_t        msg_size;     /* Message length (0 = no boundary tracking) */
+    size_t        msg_off;      /* Bytes of current message already sent     */
+    size_t        writes;       /* Sends accounted so far                    */
+    size_t        partial_writes; /* ...that did not finish the span         */
+} iov_cursor_t;
+
+// ---------------------------------------------------------------------------
+//  cpu_pin_t
+//  ---------
+//  Where connection threads run, selected at startup with --cpus.  The rx
+//  modes read SO_INCOMING_CPU — the CPU whose softirq last processed the
+//  socket's packets — once the connection is up: "rx" shares that CPU
+//  (receive data still hot in its caches, but sender and softirq compete
+//  for it), "rx-next" takes the next CPU of the same NUMA node (same LLC,
+//  no competition).
+// ---------------------------------------------------------------------------
+typedef enum {
+    CPU_PIN_NONE = 0,           /* Threads float (original PA02)             */
+    CPU_PIN_LIST,               /* Thread i on cpus[i % n_cpus]              */
+    CPU_PIN_RX,                 /* On the socket's SO_INCOMING_CPU           */
+    CPU_PIN_RX_NEXT             /* Next CPU on that CPU's NUMA node          */
+} cpu_pin_t;
+
 // ===========================================================================
 //  Utility Function Declarations
 // ===========================================================================
 
+// ---------------------------------------------------------------------------
+//  message_layout
+//  --------------
+//  Builds the field layout of a msg_size-byte message.  `profile` is one
+//  of
+//      uniform    – msg_size / n_fields bytes each, remainder in the last
+//      skewed     – one large field plus many small ones: fields 0..n-2
+//                   are headers of SKEW_SMALL_BYTES (less if msg_size is
+//                   too small to keep the last field at least half the
+//                   message), the last field carries the rest
+//      geometric  – every field gets half of what is left, the last field
+//                   the remainder (512,256,...,8,8 for 1 KB / 8 fields)
+//  or an explicit list such as "16,16,32,*": comma-separated byte counts,
+//  at most one of which may be "*" for "whatever is left of msg_size".
+//  A list sets the field count itself.
+//
+//  Parameters:
+//      n_fields – field count, or 0 for the default (NUM_FIELDS, or the
+//                 length of an explicit list)
+//      profile  – profile name or list; NULL means "uniform"
+//
+//  Returns:
+//      0 on success, -1 if the profile is unknown, the list is malformed
+//      or does not add up to msg_size, or n_fields is out of range.
+// ---------------------------------------------------------------------------
+int message_layout(msg_layout_t *layout, size_t msg_size, int n_fields,
+                   const char *profile);
+
 // ---------------------------------------------------------------------------
 //  allocate_message
 //  ----------------
-//  Allocates heap memory for each of the 8 string fields inside *msg.
-//  Each field receives (msg_size / NUM_FIELDS) bytes.
+//  Allocates heap memory for each field of *msg: field i receives
+//  layout->size[i] bytes.  Zero-byte fields still get a valid pointer.
+//
+//  Parameters:
+//      msg    – pointer to an existing message_t whose fields will be
+//               allocated
+//      layout – field count and sizes (see message_layout())
+// ---------------------------------------------------------------------------
+void allocate_message(message_t *msg, const msg_layout_t *layout);
+
+// ---------------------------------------------------------------------------
+//  allocate_message_aligned
+//  ------------------------
+//  Same as allocate_message(), but every field buffer starts on an
+//  `align`-byte boundary (a power of two, e.g. the page size for splice).
+//  align == 0 behaves exactly like allocate_message().
+// ---------------------------------------------------------------------------
+void allocate_message_aligned(message_t *msg, const msg_layout_t *layout,
+                              size_t align);
+
+// ---------------------------------------------------------------------------
+//  allocate_message_block
+//  ----------------------
+//  Allocates every field of *msg from ONE block: field i starts at the
+//  first `align`-byte boundary (a power of two; 1 = back to back) after
+//  field i-1, and the block itself starts on a max(align, cache line)
+//  boundary.  free_message() releases the block.
+//
+//  Like allocate_message(), the memory comes from pool_alloc(), i.e. from
+//  huge-page arenas when --pool selected them.
+// ---------------------------------------------------------------------------
+void allocate_message_block(message_t *msg, const msg_layout_t *layout,
+                            size_t align);
+
+// ---------------------------------------------------------------------------
+//  allocate_message_as
+//  -------------------
+//  Allocates *msg the way --alloc selected: allocate_message() for
+//  MSG_ALLOC_SCATTER, otherwise allocate_message_block() with 1, the
+//  cache-line size or the page size as the field alignment.
+// ---------------------------------------------------------------------------
+void allocate_message_as(message_t *msg, const msg_layout_t *layout,
+                         msg_alloc_t alloc);
+
+// ---------------------------------------------------------------------------
+//  parse_msg_alloc / msg_alloc_name
+//  --------------------------------
+//  Convert between MSG_ALLOC_* and "scatter" | "packed" | "line" | "page".
+//  parse_msg_alloc() returns 0, or -1 for an unknown name.
+// ---------------------------------------------------------------------------
+int         parse_msg_alloc(const char *str, msg_alloc_t *alloc);
+const char *msg_alloc_name(msg_alloc_t alloc);
+
+// ---------------------------------------------------------------------------
+//  message_iov
+//  -----------
+//  Describes fields [first, first + n) of *msg as an iovec for sendmsg()
+//  / vmsplice() and friends.  Empty fields are left out, and when the
+//  message is a single block, a field that starts exactly where the
+//  previous entry ends is merged into that entry — so a packed message
+//  (or a line-aligned one whose fields are multiples of 64 bytes) goes
+//  out as ONE entry.  The result depends only on the layout and --alloc,
+//  so every message allocated the same way yields the same entry count.
 //
 //  Parameters:
-//      msg      – pointer to an existing message_t whose fields will be
-//                 allocated
-//      msg_size – total desired message payload size in bytes
+//      iov – room for at least n entries
+//
+//  Returns:
+//      Number of entries written (0 if every field in the range is empty).
 // ---------------------------------------------------------------------------
-void allocate_message(message_t *msg, size_t msg_size);
+int message_iov(const message_t *msg, const msg_layout_t *layout,
+                int first, int n, struct iovec *iov);
 
 // ---------------------------------------------------------------------------
 //  free_message
 //  ------------
-//  Frees every dynamically allocated field inside *msg and sets the
-//  pointers to NULL to prevent dangling references.
+//  Frees every dynamically allocated field inside *msg, and the field
+//  table itself, and sets the pointers to NULL to prevent dangling
+//  references.
 //
 //  Parameters:
 //      msg – pointer to a message_t whose fields should be freed
@@ -136,15 +333,15 @@ void free_message(message_t *msg);
 // ---------------------------------------------------------------------------
 //  fill_message
 //  ------------
-//  Populates all 8 fields of *msg with synthetic payload data (e.g., a
-//  repeating character pattern).  Useful for generating deterministic
-//  content before sending.
+//  Populates every field of *msg with synthetic payload data (a repeating
+//  character pattern).  Useful for generating deterministic content
+//  before sending.
 //
 //  Parameters:
-//      msg      – pointer to a previously allocated message_t
-//      msg_size – total message size (each field gets msg_size / 8 bytes)
+//      msg    – pointer to a previously allocated message_t
+//      layout – the layout it was allocated with
 // ---------------------------------------------------------------------------
-void fill_message(message_t *msg, size_t msg_size);
+void fill_message(message_t *msg, const msg_layout_t *layout);
 
 // ---------------------------------------------------------------------------
 //  get_time_us
@@ -158,4 +355,135 @@ void fill_message(message_t *msg, size_t msg_size);
 // ---------------------------------------------------------------------------
 double get_time_us(void);
 
+// ---------------------------------------------------------------------------
+//  iov_tail
+//  --------
+//  Builds, in out[], the part of iov[0..iovcnt-1] that remains after the
+//  first `skip` bytes have already been transmitted.  Used by the vectored
+//  senders to resume a message after a short sendmsg().
+//
+//  Parameters:
+//      iov    – the full message iovec
+//      iovcnt – number of entries in iov
+//      skip   – bytes of the message already sent
+//      out    – destination array with room for iovcnt entries
+//
+//  Returns:
+//      Number of entries written to out (0 if nothing remains).
+// ---------------------------------------------------------------------------
+int iov_tail(const struct iovec *iov, int iovcnt, size_t skip,
+             struct iovec *out);
+
+// ---------------------------------------------------------------------------
+//  iov_cursor_start
+//  ----------------
+//  Points the cursor at a new span iov[0..iovcnt-1].  msg_size is the
+//  length of one message inside the span, or 0 when the span is only part
+//  of a message and boundaries are tracked by the caller.
+// ---------------------------------------------------------------------------
+void iov_cursor_start(iov_cursor_t *cur, struct iovec *iov, int iovcnt,
+                      size_t msg_size);
+
+// ---------------------------------------------------------------------------
+//  iov_cursor_advance
+//  ------------------
+//  Accounts for a send that accepted n bytes of the span: skips entries
+//  sent in full (restoring them), trims the first partially sent one, and
+//  counts the write.
+//
+//  Returns:
+//      Number of messages of msg_size bytes completed by these n bytes
+//      (always 0 when msg_size is 0).
+// ---------------------------------------------------------------------------
+size_t iov_cursor_advance(iov_cursor_t *cur, size_t n);
+
+// ---------------------------------------------------------------------------
+//  iov_cursor_done
+//  ---------------
+//  True when the whole span has been sent (or no span was started yet).
+// ---------------------------------------------------------------------------
+static inline bool iov_cursor_done(const iov_cursor_t *cur)
+{
+    return cur->remaining == 0;
+}
+
+// ---------------------------------------------------------------------------
+//  parse_cpu_list
+//  --------------
+//  Parses a CPU list in the kernel's cpulist syntax ("0-3,8,10-11") into
+//  cpus[].  Used by the affinity options of the servers and clients.
+//
+//  Parameters:
+//      str  – the list to parse
+//      cpus – destination array
+//      max  – capacity of cpus
+//
+//  Returns:
+//      Number of CPUs parsed, or -1 if the string is malformed / empty.
+// ---------------------------------------------------------------------------
+int parse_cpu_list(const char *str, int *cpus, int max);
+
+// ---------------------------------------------------------------------------
+//  pin_thread_to_cpu
+//  -----------------
+//  Restricts the calling thread to a single CPU.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set by pthread_setaffinity_np).
+// ---------------------------------------------------------------------------
+int pin_thread_to_cpu(int cpu);
+
+// ---------------------------------------------------------------------------
+//  parse_cpu_pin
+//  -------------
+//  Parses a --cpus argument: "rx", "rx-next", or a cpulist (filled into
+//  cpus[] as by parse_cpu_list()).  numa_discover() must have run.
+//
+//  Returns:
+//      Number of CPUs in the list (0 for the rx modes), or -1.
+// ---------------------------------------------------------------------------
+int parse_cpu_pin(const char *str, cpu_pin_t *pin, int *cpus, int max);
+
+// ---------------------------------------------------------------------------
+//  socket_rx_cpu / rx_pin_cpu
+//  --------------------------
+//  socket_rx_cpu() returns the socket's SO_INCOMING_CPU, or -1 if the
+//  kernel has not recorded one yet.  rx_pin_cpu() maps it to the CPU a
+//  CPU_PIN_RX / CPU_PIN_RX_NEXT thread should run on (-1 stays -1).
+// ---------------------------------------------------------------------------
+int socket_rx_cpu(int fd);
+int rx_pin_cpu(int rx_cpu, cpu_pin_t pin);
+
+// ---------------------------------------------------------------------------
+//  set_thread_fifo
+//  ---------------
+//  Switches the calling thread to SCHED_FIFO at priority `prio` (1..99).
+//  Needs CAP_SYS_NICE or an RLIMIT_RTPRIO allowance.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int set_thread_fifo(int prio);
+
+// ---------------------------------------------------------------------------
+//  get_thread_cpu_s
+//  ----------------
+//  Returns the user + system CPU time consumed by the calling thread, in
+//  seconds (getrusage(RUSAGE_THREAD)).  Servers diff two readings to report
+//  the CPU cost of a connection next to its throughput.
+// ---------------------------------------------------------------------------
+double get_thread_cpu_s(void);
+
+// ---------------------------------------------------------------------------
+//  get_tcp_data_segs_out
+//  ---------------------
+//  Reads the number of data-carrying TCP segments the socket has sent
+//  (tcpi_data_segs_out from TCP_INFO, Linux >= 4.6).  Servers report it
+//  with their totals to show how many segments a send pattern produces.
+//
+//  Returns:
+//      0 on success, -1 if the kernel does not provide the counter.
+// ---------------------------------------------------------------------------
+int get_tcp_data_segs_out(int fd, size_t *segs);
+
 #endif /* MT25082_COMMON_H */
@@ -0,0 +1,298 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_numa.c
+// Purpose: Implements the NUMA placement helpers declared in MT25082_numa.h.
+//
+// Design notes:
+//   • Topology comes from sysfs (node/online, nodeN/cpulist) once at
+//     startup and is read-only afterwards, so lookups need no locking.
+//   • The home node and the tracked-buffer list are thread-local: every
+//     connection thread (or event-loop worker) owns its own.
+//   • Node masks are a single unsigned long, hence NUMA_MAX_NODES = 64.
+//     The kernel ignores the top bit of `maxnode`, so 65 is passed.
+// =============================================================================
+
+#define _GNU_SOURCE             /* CPU_* macros, pthread_setaffinity_np      */
+
+#include "MT25082_numa.h"
+#include "MT25082_common.h"     /* parse_cpu_list, MAX_CPUS                  */
+
+#include <linux/mempolicy.h>    /* MPOL_PREFERRED, MPOL_MF_MOVE              */
+#include <sched.h>              /* cpu_set_t, sched_getaffinity              */
+#include <sys/syscall.h>        /* __NR_mbind, __NR_set_mempolicy, ...       */
+
+// ===========================================================================
+//  System-call shims (glibc provides no wrappers; libnuma would)
+// ===========================================================================
+static long sys_set_mempolicy(int mode, const unsigned long *mask,
+                              unsigned long maxnode)
+{
+    return syscall(__NR_set_mempolicy, mode, mask, maxnode);
+}
+
+static long sys_mbind(void *addr, unsigned long len, int mode,
+                      const unsigned long *mask, unsigned long maxnode,
+                      unsigned flags)
+{
+    return syscall(__NR_mbind, addr, len, mode, mask, maxnode, flags);
+}
+
+static long sys_move_pages(unsigned long count, void **pages, int *status)
+{
+    /* nodes == NULL: only report where each page currently is */
+    return syscall(__NR_move_pages, 0, count, pages, NULL, status, 0);
+}
+
+// ===========================================================================
+//  Topology and per-thread state
+// ===========================================================================
+
+static int       g_node_ids[NUMA_MAX_NODES];   /* Online nodes with CPUs    */
+static int       g_node_count = 0;
+static cpu_set_t g_node_cpus[NUMA_MAX_NODES];  /* Indexed by node ID        */
+static bool      g_online[NUMA_MAX_NODES];
+
+static __thread int t_node = NUMA_OFF;         /* Home node of this thread  */
+
+typedef struct {
+    const char *addr;
+    size_t      len;
+} numa_range_t;
+
+static __thread numa_range_t t_tracked[NUMA_MAX_TRACKED];
+static __thread int          t_n_tracked = 0;
+
+// ---------------------------------------------------------------------------
+//  read_list — reads a sysfs cpulist / nodelist file into ids[].
+// ---------------------------------------------------------------------------
+static int read_list(const char *path, int *ids, int max)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+    char line[4096];
+    int  n = -1;
+    if (fgets(line, sizeof(line), f) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        n = (line[0] != '\0') ? parse_cpu_list(line, ids, max) : 0;
+    }
+    fclose(f);
+    return n;
+}
+
+// ===========================================================================
+//  numa_discover
+// ===========================================================================
+int numa_discover(void)
+{
+    static int cpus[MAX_CPUS];
+    int nodes[NUMA_MAX_NODES];
+
+    g_node_count = 0;
+    int n_online = read_list("/sys/devices/system/node/online",
+                             nodes, NUMA_MAX_NODES);
+
+    for (int i = 0; i < n_online; i++) {
+        int node = nodes[i];
+        char path[64];
+        if (node >= NUMA_MAX_NODES) {
+            continue;
+        }
+        snprintf(path, sizeof(path),
+                 "/sys/devices/system/node/node%d/cpulist", node);
+
+        g_online[node] = true;
+        CPU_ZERO(&g_node_cpus[node]);
+        int n_cpus = read_list(path, cpus, MAX_CPUS);
+        for (int c = 0; c < n_cpus; c++) {
+            CPU_SET(cpus[c], &g_node_cpus[node]);
+        }
+        if (n_cpus > 0) {
+            g_node_ids[g_node_count++] = node;   /* Memory-only nodes skipped */
+        }
+    }
+
+    /* No sysfs node directory: one node owning every CPU we may use */
+    if (g_node_count == 0) {
+        g_online[0]   = true;
+        g_node_ids[0] = 0;
+        g_node_count  = 1;
+        sched_getaffinity(0, sizeof(g_node_cpus[0]), &g_node_cpus[0]);
+    }
+    return g_node_count;
+}
+
+// ===========================================================================
+//  parse_numa_policy / numa_pick / numa_cpu_node / numa_next_cpu
+// ===========================================================================
+int parse_numa_policy(const char *str, int *policy)
+{
+    if (strcmp(str, "rr") == 0) {
+        *policy = NUMA_RR;
+        return 0;
+    }
+    char *end;
+    long node = strtol(str, &end, 10);
+    if (end == str || *end != '\0' || node < 0 || node >= NUMA_MAX_NODES ||
+        !g_online[node]) {
+        return -1;
+    }
+    *policy = (int)node;
+    return 0;
+}
+
+int numa_pick(int policy, int index)
+{
+    if (policy == NUMA_RR) {
+        return g_node_ids[index % g_node_count];
+    }
+    return policy;              /* NUMA_OFF or a fixed node */
+}
+
+int numa_cpu_node(int cpu)
+{
+    for (int i = 0; i < g_node_count; i++) {
+        if (CPU_ISSET(cpu, &g_node_cpus[g_node_ids[i]])) {
+            return g_node_ids[i];
+        }
+    }
+    return 0;
+}
+
+int numa_next_cpu(int cpu)
+{
+    const cpu_set_t *set = &g_node_cpus[numa_cpu_node(cpu)];
+    for (int i = 1; i < CPU_SETSIZE; i++) {
+        int next = (cpu + i) % CPU_SETSIZE;
+        if (CPU_ISSET(next, set)) {
+            return next;
+        }
+    }
+    return cpu;
+}
+
+// ===========================================================================
+//  numa_run_on / numa_bind_memory / numa_thread_node
+// ===========================================================================
+int numa_run_on(int node)
+{
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                                    &g_node_cpus[node]);
+    if (rc != 0) {
+        errno = rc;
+        return -1;
+    }
+    return 0;
+}
+
+int numa_bind_memory(int node)
+{
+    unsigned long mask = 1UL << node;
+    if (sys_set_mempolicy(MPOL_PREFERRED, &mask, NUMA_MAX_NODES + 1) < 0) {
+        return -1;
+    }
+    t_node = node;
+    return 0;
+}
+
+int numa_thread_node(void)
+{
+    return t_node;
+}
+
+// ===========================================================================
+//  numa_place_range
+// ===========================================================================
+int numa_place_range(void *addr, size_t len, int node)
+{
+    uintptr_t page  = (uintptr_t)sysconf(_SC_PAGESIZE);
+    uintptr_t start = ((uintptr_t)addr + page - 1) & ~(page - 1);
+    uintptr_t end   = ((uintptr_t)addr + len) & ~(page - 1);
+    if (end <= start) {
+        return 0;               /* No whole page inside the buffer */
+    }
+
+    unsigned long mask = 1UL << node;
+    if (sys_mbind((void *)start, end - start, MPOL_PREFERRED, &mask,
+                  NUMA_MAX_NODES + 1, MPOL_MF_MOVE) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// ===========================================================================
+//  numa_track_reset / numa_track
+// ===========================================================================
+void numa_track_reset(void)
+{
+    t_n_tracked = 0;
+}
+
+void numa_track(const void *addr, size_t len)
+{
+    if (t_n_tracked < NUMA_MAX_TRACKED) {
+        t_tracked[t_n_tracked].addr = (const char *)addr;
+        t_tracked[t_n_tracked].len  = len;
+        t_n_tracked++;
+    }
+}
+
+// ===========================================================================
+//  numa_track_report
+// ===========================================================================
+//  Queries every page of every tracked buffer in batches.  Pages shared by
+//  two small buffers are counted once per buffer — the report is about
+//  placement, not footprint.
+// ---------------------------------------------------------------------------
+void numa_track_report(char *buf, size_t cap)
+{
+    enum { BATCH = 64 };
+    size_t    on_node[NUMA_MAX_NODES] = { 0 };
+    size_t    absent = 0;
+    uintptr_t page   = (uintptr_t)sysconf(_SC_PAGESIZE);
+
+    for (int r = 0; r < t_n_tracked; r++) {
+        uintptr_t p   = (uintptr_t)t_tracked[r].addr & ~(page - 1);
+        uintptr_t end = (uintptr_t)t_tracked[r].addr + t_tracked[r].len;
+
+        while (p < end) {
+            void *pages[BATCH];
+            int   status[BATCH];
+            int   n = 0;
+            for (; n < BATCH && p < end; n++, p += page) {
+                pages[n] = (void *)p;
+            }
+            if (sys_move_pages((unsigned long)n, pages, status) < 0) {
+                snprintf(buf, cap, "unknown (move_pages: %s)",
+                         strerror(errno));
+                return;
+            }
+            for (int i = 0; i < n; i++) {
+                if (status[i] >= 0 && status[i] < NUMA_MAX_NODES) {
+                    on_node[status[i]]++;
+                } else {
+                    absent++;   /* -ENOENT: not faulted in yet */
+                }
+            }
+        }
+    }
+
+    size_t used = 0;
+    int    shown = 0;
+    buf[0] = '\0';
+    for (int node = 0; node < NUMA_MAX_NODES && used < cap; node++) {
+        if (on_node[node] == 0) {
+            continue;
+        }
+        used += (size_t)snprintf(buf + used, cap - used, "%snode %d: %zu",
+                                 shown++ ? ", " : "", node, on_node[node]);
+    }
+    if (used < cap) {
+        used += (size_t)snprintf(buf + used, cap - used, "%s",
+                                 shown ? " pages" : "no pages");
+    }
+    if (absent > 0 && used < cap) {
+        snprintf(buf + used, cap - used, ", %zu not faulted", absent);
+    }
+}
@@ -0,0 +1,156 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_numa.h
+// Purpose: NUMA placement of connection threads and their buffers.
+//
+//          On a multi-socket machine a thread that copies out of (or DMA
+//          reads from) memory on the other socket pays a remote access per
+//          cache line; it shows up as LLC misses and a throughput cliff once
+//          the thread count exceeds one socket.  With --numa every
+//          connection thread is kept on one node:
+//
+//            • its CPUs           – sched affinity to the node's cpulist,
+//                                   so the socket's sk_buffs are also
+//                                   allocated and processed node-locally,
+//            • its memory policy  – set_mempolicy(MPOL_PREFERRED), so the
+//                                   heap pages it first-touches come from
+//                                   the node,
+//            • its pool arenas    – mbind(MPOL_PREFERRED) before prefault
+//                                   (see MT25082_pool.c).
+//
+//          Everything goes through the raw system calls and sysfs, so no
+//          libnuma is needed at build time.  MPOL_PREFERRED (rather than
+//          MPOL_BIND) falls back to another node instead of failing when
+//          the node is full; the per-connection report shows where the
+//          buffers actually landed (move_pages(2) status query).
+// =============================================================================
+
+#ifndef MT25082_NUMA_H
+#define MT25082_NUMA_H
+
+#include <stddef.h>             /* size_t                                    */
+
+// ===========================================================================
+//  Constants
+// ===========================================================================
+
+#define NUMA_MAX_NODES     64   /* Nodes tracked (node IDs 0..63).            */
+
+#define NUMA_MAX_TRACKED   256  /* Buffers remembered per thread for the
+                                   placement report.                          */
+
+#define NUMA_OFF           (-1) /* --numa not given: no placement.            */
+
+#define NUMA_RR            (-2) /* --numa rr: round-robin over the nodes.     */
+
+// ===========================================================================
+//  Function Declarations
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  numa_discover
+//  -------------
+//  Reads the online nodes and their CPU lists from
+//  /sys/devices/system/node.  Call once at startup, before any other
+//  numa_* function.  A kernel without NUMA support counts as one node
+//  holding every CPU.
+//
+//  Returns:
+//      Number of nodes with CPUs (≥ 1).
+// ---------------------------------------------------------------------------
+int numa_discover(void);
+
+// ---------------------------------------------------------------------------
+//  parse_numa_policy
+//  -----------------
+//  Parses a --numa argument: "rr" → NUMA_RR, or a node ID that must be
+//  online (so numa_discover() must have run).  Returns 0, or -1.
+// ---------------------------------------------------------------------------
+int parse_numa_policy(const char *str, int *policy);
+
+// ---------------------------------------------------------------------------
+//  numa_pick
+//  ---------
+//  Node for the index-th connection / worker / thread under `policy`:
+//  NUMA_OFF for NUMA_OFF, the index-th node with CPUs for NUMA_RR, or
+//  the fixed node itself.
+// ---------------------------------------------------------------------------
+int numa_pick(int policy, int index);
+
+// ---------------------------------------------------------------------------
+//  numa_cpu_node
+//  -------------
+//  Node owning `cpu`, or 0 if it is not listed (single-node fallback).
+// ---------------------------------------------------------------------------
+int numa_cpu_node(int cpu);
+
+// ---------------------------------------------------------------------------
+//  numa_next_cpu
+//  -------------
+//  The CPU after `cpu` (wrapping around) on the same node, or `cpu`
+//  itself if it is the node's only CPU.
+// ---------------------------------------------------------------------------
+int numa_next_cpu(int cpu);
+
+// ---------------------------------------------------------------------------
+//  numa_run_on
+//  -----------
+//  Restricts the calling thread to the CPUs of `node`.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int numa_run_on(int node);
+
+// ---------------------------------------------------------------------------
+//  numa_bind_memory
+//  ----------------
+//  Gives the calling thread an MPOL_PREFERRED policy for `node` and
+//  records the node as the thread's home node (numa_thread_node()), which
+//  the buffer pool uses to pick a node-local arena.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int numa_bind_memory(int node);
+
+// ---------------------------------------------------------------------------
+//  numa_thread_node
+//  ----------------
+//  Home node of the calling thread, or NUMA_OFF if it has none.
+// ---------------------------------------------------------------------------
+int numa_thread_node(void);
+
+// ---------------------------------------------------------------------------
+//  numa_place_range
+//  ----------------
+//  mbind()s the whole pages of [addr, addr + len) to `node` with
+//  MPOL_PREFERRED, moving pages already faulted elsewhere.  Pages are
+//  rounded inwards, so a neighbour's partial page is never touched.
+//
+//  Returns:
+//      0 on success (or nothing to bind), -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int numa_place_range(void *addr, size_t len, int node);
+
+// ---------------------------------------------------------------------------
+//  numa_track_reset / numa_track
+//  -----------------------------
+//  Per-thread list of buffers to include in the next placement report.
+//  The pool calls numa_track() for every buffer a thread with a home node
+//  allocates; the runtimes reset the list before opening a connection.
+//  Buffers past NUMA_MAX_TRACKED are not reported.
+// ---------------------------------------------------------------------------
+void numa_track_reset(void);
+void numa_track(const void *addr, size_t len);
+
+// ---------------------------------------------------------------------------
+//  numa_track_report
+//  -----------------
+//  Formats where the tracked buffers' pages live right now, e.g.
+//  "node 1: 24 pages" or "node 0: 20, node 1: 4 pages, 2 not faulted".
+//  Call after the buffers were first written.
+// ---------------------------------------------------------------------------
+void numa_track_report(char *buf, size_t cap);
+
+#endif /* MT25082_NUMA_H */
@@ -0,0 +1,386 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_pool.c
+// Purpose: Implements the huge-page buffer pool declared in MT25082_pool.h.
+//
+// Design notes:
+//   • Arenas are few (one per POOL_ARENA_BYTES of live buffers) and buffers
+//     are allocated per connection, not per send, so a single mutex and a
+//     linear arena list are plenty.
+//   • THP arenas are mapped one huge page larger than needed and trimmed
+//     to a huge-page boundary: khugepaged / the fault path can only use a
+//     PMD mapping for a 2 MB-aligned 2 MB range.
+//   • Prefaulting writes one byte per base page.  For a THP arena the
+//     first write into each 2 MB range faults in the whole huge page (when
+//     one is available); the remaining writes are then plain stores.
+//     hugetlb arenas are prefaulted the same way rather than with
+//     MAP_POPULATE, so a --numa node policy is in place before the first
+//     fault (the mmap() reservation guarantees the pages exist).
+//   • With --numa, arenas belong to a node: a thread only allocates from
+//     arenas of its home node (numa_thread_node()).
+//   • Every buffer is preceded by a POOL_HDR_BYTES header holding its size
+//     and, once freed, its free-list link.  Buffer sizes are fixed for a
+//     run (msg_size, the field sizes, the ring), so the exact size is the
+//     size class: a freed buffer is handed back unchanged to the next
+//     request of the same size and alignment, and a closing connection
+//     no longer strands its space until every other buffer in the arena
+//     is gone too.
+// =============================================================================
+
+#define _GNU_SOURCE             /* MAP_HUGETLB, MADV_HUGEPAGE                */
+
+#include "MT25082_pool.h"
+#include "MT25082_numa.h"       /* numa_thread_node, numa_place_range        */
+
+#include <errno.h>              /* errno                                     */
+#include <pthread.h>            /* pthread_mutex_t                           */
+#include <stdint.h>             /* uintptr_t                                 */
+#include <stdio.h>              /* printf, fprintf, fopen                    */
+#include <stdlib.h>             /* malloc, posix_memalign, free              */
+#include <string.h>             /* strcmp, strerror                          */
+#include <sys/mman.h>           /* mmap, munmap, madvise, mlock              */
+#include <unistd.h>             /* sysconf                                   */
+
+// ===========================================================================
+//  Pool state
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  pool_hdr_t — sits in the POOL_HDR_BYTES just before every buffer.
+// ---------------------------------------------------------------------------
+typedef struct pool_hdr {
+    size_t           size;              /* Requested size (the size class)   */
+    struct pool_hdr *next_free;         /* Free-list link while freed        */
+} pool_hdr_t;
+
+_Static_assert(sizeof(pool_hdr_t) <= POOL_HDR_BYTES,
+               "pool_hdr_t must fit in POOL_HDR_BYTES");
+
+#define POOL_BUF(h)  ((char *)(h) + POOL_HDR_BYTES)
+#define POOL_HDR(p)  ((pool_hdr_t *)((char *)(p) - POOL_HDR_BYTES))
+
+// ---------------------------------------------------------------------------
+//  pool_arena_t — one mapping; buffers are bump-allocated from `used` or
+//  recycled from `free_list`.
+// ---------------------------------------------------------------------------
+typedef struct pool_arena {
+    struct pool_arena *next;
+    char              *base;            /* Start of the usable mapping       */
+    size_t             size;            /* Usable bytes                      */
+    void              *map;             /* As returned by mmap (for munmap)  */
+    size_t             map_size;
+    size_t             used;            /* Bump pointer (offset from base)   */
+    size_t             live;            /* Buffers handed out, not yet freed */
+    pool_hdr_t        *free_list;       /* Freed buffers, any size           */
+    int                node;            /* Home node, or NUMA_OFF            */
+} pool_arena_t;
+
+static pthread_mutex_t g_pool_lock   = PTHREAD_MUTEX_INITIALIZER;
+static pool_type_t     g_pool_type   = POOL_MALLOC;
+static bool            g_pool_mlock  = false;
+static pool_arena_t   *g_arenas      = NULL;
+static size_t          g_arena_count = 0;
+static size_t          g_mapped      = 0;   /* Bytes mapped in all arenas    */
+static size_t          g_fallbacks   = 0;   /* hugetlb arenas mapped as THP  */
+static size_t          g_lock_fails  = 0;   /* Arenas mlock() refused        */
+
+static const char *const pool_type_names[] = { "malloc", "thp", "hugetlb" };
+
+// ===========================================================================
+//  pool_configure
+// ===========================================================================
+void pool_configure(pool_type_t type, bool lock)
+{
+    g_pool_type  = type;
+    g_pool_mlock = lock;
+}
+
+// ===========================================================================
+//  parse_pool_type / pool_type_name
+// ===========================================================================
+int parse_pool_type(const char *str, pool_type_t *type)
+{
+    for (int i = 0; i <= POOL_HUGETLB; i++) {
+        if (strcmp(str, pool_type_names[i]) == 0) {
+            *type = (pool_type_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *pool_type_name(pool_type_t type)
+{
+    return pool_type_names[type];
+}
+
+// ===========================================================================
+//  pool_map_arena
+// ===========================================================================
+//  Maps, places on `node` (unless NUMA_OFF), prefaults and (optionally)
+//  locks a new arena of at least `need` bytes.  Called with g_pool_lock
+//  held.
+// ---------------------------------------------------------------------------
+static pool_arena_t *pool_map_arena(size_t need, int node)
+{
+    size_t size = (need > POOL_ARENA_BYTES) ? need : POOL_ARENA_BYTES;
+    size = (size + POOL_HUGE_PAGE - 1) & ~(POOL_HUGE_PAGE - 1);
+
+    pool_arena_t *a = (pool_arena_t *)calloc(1, sizeof(pool_arena_t));
+    if (a == NULL) {
+        return NULL;
+    }
+
+    /* ---- hugetlb: pages reserved from vm.nr_hugepages at mmap() ------- */
+    if (g_pool_type == POOL_HUGETLB) {
+        a->map = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (a->map != MAP_FAILED) {
+            a->map_size = size;
+            a->base     = (char *)a->map;
+        } else {
+            if (g_fallbacks++ == 0) {
+                fprintf(stderr, "[pool] MAP_HUGETLB: %s — using THP "
+                        "(reserve pages with vm.nr_hugepages)\n",
+                        strerror(errno));
+            }
+        }
+    }
+
+    /* ---- THP: over-map, trim to a huge-page boundary, then advise ----- */
+    if (a->base == NULL) {
+        a->map_size = size + POOL_HUGE_PAGE;
+        a->map      = mmap(NULL, a->map_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (a->map == MAP_FAILED) {
+            int saved = errno;
+            free(a);
+            errno = saved;
+            return NULL;
+        }
+        uintptr_t start = ((uintptr_t)a->map + POOL_HUGE_PAGE - 1) &
+                          ~(uintptr_t)(POOL_HUGE_PAGE - 1);
+        a->base = (char *)start;
+        if (madvise(a->base, size, MADV_HUGEPAGE) < 0) {
+            perror("[pool] madvise(MADV_HUGEPAGE)");
+        }
+    }
+    a->size = size;
+    a->node = node;
+
+    if (node != NUMA_OFF && numa_place_range(a->base, size, node) < 0) {
+        perror("[pool] mbind");
+    }
+
+    /* Prefault: no first-touch page faults once the run is timed */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    for (size_t off = 0; off < size; off += page) {
+        ((volatile char *)a->base)[off] = 0;
+    }
+
+    if (g_pool_mlock && mlock(a->base, a->size) < 0) {
+        if (g_lock_fails++ == 0) {
+            fprintf(stderr, "[pool] mlock: %s — arenas stay unlocked "
+                    "(raise RLIMIT_MEMLOCK)\n", strerror(errno));
+        }
+    }
+
+    a->next   = g_arenas;
+    g_arenas  = a;
+    g_arena_count++;
+    g_mapped += a->size;
+    return a;
+}
+
+// ===========================================================================
+//  pool_alloc
+// ===========================================================================
+//  With a home node, malloc() memory relies on the thread's preferred
+//  policy for fresh pages and is mbind()-moved where it spans whole pages
+//  recycled from another node.  Either way the buffer is tracked for the
+//  placement report.
+// ---------------------------------------------------------------------------
+void *pool_alloc(size_t size, size_t align)
+{
+    int node = numa_thread_node();
+
+    if (size == 0) {
+        size = 1;
+    }
+
+    if (g_pool_type == POOL_MALLOC) {
+        void *p = NULL;
+        if (align <= sizeof(void *)) {
+            p = malloc(size);
+        } else {
+            int rc = posix_memalign(&p, align, size);
+            if (rc != 0) {
+                errno = rc;
+                return NULL;
+            }
+        }
+        if (p != NULL && node != NUMA_OFF) {
+            numa_place_range(p, size, node);
+            numa_track(p, size);
+        }
+        return p;
+    }
+
+    if (align < POOL_HDR_BYTES) {
+        align = POOL_HDR_BYTES; /* >= malloc()'s alignment on 64-bit glibc */
+    }
+
+    pthread_mutex_lock(&g_pool_lock);
+
+    /* Recycle: a freed home-node buffer of the same size and alignment */
+    pool_arena_t *a;
+    size_t        off = 0;
+    for (a = g_arenas; a != NULL; a = a->next) {
+        if (a->node != node) {
+            continue;
+        }
+        for (pool_hdr_t **pp = &a->free_list; *pp != NULL;
+             pp = &(*pp)->next_free) {
+            pool_hdr_t *h = *pp;
+            if (h->size == size &&
+                ((uintptr_t)POOL_BUF(h) & (align - 1)) == 0) {
+                *pp = h->next_free;
+                a->live++;
+                pthread_mutex_unlock(&g_pool_lock);
+                if (node != NUMA_OFF) {
+                    numa_track(POOL_BUF(h), size);
+                }
+                return POOL_BUF(h);
+            }
+        }
+    }
+
+    /* First fit: bump-allocate from the first home-node arena with room */
+    for (a = g_arenas; a != NULL; a = a->next) {
+        off = (a->used + POOL_HDR_BYTES + align - 1) & ~(align - 1);
+        if (a->node == node && off + size <= a->size) {
+            break;
+        }
+    }
+    if (a == NULL) {
+        a = pool_map_arena(size + align + POOL_HDR_BYTES, node);
+        if (a == NULL) {
+            pthread_mutex_unlock(&g_pool_lock);
+            return NULL;
+        }
+        /* Arena base is huge-page aligned */
+        off = (POOL_HDR_BYTES + align - 1) & ~(align - 1);
+    }
+
+    a->used = off + size;
+    a->live++;
+    POOL_HDR(a->base + off)->size = size;
+    pthread_mutex_unlock(&g_pool_lock);
+
+    if (node != NUMA_OFF) {
+        numa_track(a->base + off, size);
+    }
+    return a->base + off;
+}
+
+// ===========================================================================
+//  pool_reserve
+// ===========================================================================
+int pool_reserve(size_t bytes, int node)
+{
+    if (g_pool_type == POOL_MALLOC) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&g_pool_lock);
+    int rc = 0;
+    pool_arena_t *a;
+    for (a = g_arenas; a != NULL; a = a->next) {
+        if (a->node == node && a->size - a->used >= bytes) {
+            break;
+        }
+    }
+    if (a == NULL && pool_map_arena(bytes, node) == NULL) {
+        rc = -1;
+    }
+    pthread_mutex_unlock(&g_pool_lock);
+    return rc;
+}
+
+// ===========================================================================
+//  pool_free
+// ===========================================================================
+//  Locates the owning arena by address and puts the buffer on its free
+//  list.  An arena whose last buffer is freed is rewound instead (and its
+//  free list dropped), not unmapped: its pages stay prefaulted (and
+//  locked) for the next connection.
+// ---------------------------------------------------------------------------
+void pool_free(void *ptr)
+{
+    if (ptr == NULL) {
+        return;
+    }
+    if (g_pool_type == POOL_MALLOC) {
+        free(ptr);
+        return;
+    }
+
+    pthread_mutex_lock(&g_pool_lock);
+    for (pool_arena_t *a = g_arenas; a != NULL; a = a->next) {
+        if ((char *)ptr >= a->base && (char *)ptr < a->base + a->size) {
+            if (--a->live == 0) {
+                a->used      = 0;
+                a->free_list = NULL;
+            } else {
+                pool_hdr_t *h = POOL_HDR(ptr);
+                h->next_free  = a->free_list;
+                a->free_list  = h;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_pool_lock);
+}
+
+// ===========================================================================
+//  pool_report
+// ===========================================================================
+//  The huge-page share comes from /proc/self/smaps_rollup (THP: the
+//  AnonHugePages line; hugetlb: Private_Hugetlb).  Nothing else in the
+//  process asks for huge pages, so the process totals are the pool's.
+// ---------------------------------------------------------------------------
+void pool_report(const char *tag)
+{
+    if (g_pool_type == POOL_MALLOC) {
+        return;
+    }
+
+    size_t huge_kb = 0;
+    FILE  *f       = fopen("/proc/self/smaps_rollup", "r");
+    if (f != NULL) {
+        char   line[128];
+        size_t kb;
+        while (fgets(line, sizeof(line), f) != NULL) {
+            if (sscanf(line, "AnonHugePages: %zu kB", &kb) == 1 ||
+                sscanf(line, "Private_Hugetlb: %zu kB", &kb) == 1) {
+                huge_kb += kb;
+            }
+        }
+        fclose(f);
+    }
+
+    pthread_mutex_lock(&g_pool_lock);
+    printf("%s Buffer pool: %s, %zu arena(s), %.1f MB mapped, %.1f MB in "
+           "huge pages%s",
+           tag, pool_type_names[g_pool_type], g_arena_count,
+           (double)g_mapped / (1 << 20), (double)huge_kb / 1024,
+           (g_pool_mlock && g_lock_fails == 0) ? ", mlocked" : "");
+    if (g_fallbacks > 0) {
+        printf(", %zu hugetlb → THP fallback(s)", g_fallbacks);
+    }
+    if (g_lock_fails > 0) {
+        printf(", %zu mlock failure(s)", g_lock_fails);
+    }
+    printf("\n");
+    pthread_mutex_unlock(&g_pool_lock);
+}
@@ -0,0 +1,132 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_pool.h
+// Purpose: Huge-page backed buffer pool for the PA02 message and receive
+//          buffers.
+//
+//          By default every buffer comes from malloc() on 4 KB pages: a
+//          MSG_ZEROCOPY send pins one page per 4 KB, a large buffer costs
+//          one TLB entry per 4 KB, and the first pass over a fresh buffer
+//          takes a page fault per page — inside the timed run.  The pool
+//          instead carves buffers out of a few large arenas that are
+//
+//            • backed by huge pages — MAP_HUGETLB (pre-reserved pages, see
+//              vm.nr_hugepages) or transparent huge pages requested with
+//              madvise(MADV_HUGEPAGE),
+//            • prefaulted when they are mapped, so no first-touch faults
+//              reach the measurement,
+//            • optionally mlock()ed, so they are never reclaimed or
+//              migrated while the kernel holds references to them.
+//
+// Arena anatomy:
+// ==============
+//
+//   mmap'd arena (multiple of the huge-page size)
+//  +---+-----------+---+-----------+--------+-------------------------+
+//  | h | buffer 0  | h | buffer 1  |  ...   | free (bump ptr → end)   |
+//  +---+-----------+---+-----------+--------+-------------------------+
+//    h = POOL_HDR_BYTES header: buffer size, free-list link
+//
+//   Buffers are bump-allocated (each start aligned as requested) and an
+//   arena counts its live buffers.  A freed buffer goes on its arena's
+//   free list and is reused by the next request of the same size and
+//   alignment; when the last one is freed the arena is rewound.  Either
+//   way the memory stays mapped and prefaulted, so connection churn does
+//   not grow the pool.  With --numa each arena is placed on, and only
+//   serves threads of, one node (MT25082_numa.h).
+// =============================================================================
+
+#ifndef MT25082_POOL_H
+#define MT25082_POOL_H
+
+#include <stddef.h>             /* size_t                                    */
+#include <stdbool.h>            /* bool                                      */
+
+// ===========================================================================
+//  Constants
+// ===========================================================================
+
+#define POOL_HUGE_PAGE     (2UL << 20)  /* x86-64 PMD huge page (2 MB).       */
+
+#define POOL_ARENA_BYTES   (8UL << 20)  /* Minimum arena mapping size.        */
+
+#define POOL_HDR_BYTES     16           /* Header ahead of each arena buffer. */
+
+// ===========================================================================
+//  Data Structures
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  pool_type_t
+//  -----------
+//  Backing memory selected at startup with --pool.
+// ---------------------------------------------------------------------------
+typedef enum {
+    POOL_MALLOC = 0,            /* malloc() / posix_memalign() (original)    */
+    POOL_THP,                   /* Anonymous mmap + MADV_HUGEPAGE            */
+    POOL_HUGETLB                /* MAP_HUGETLB, falls back to THP            */
+} pool_type_t;
+
+// ===========================================================================
+//  Function Declarations
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  pool_configure
+//  --------------
+//  Selects the backing memory for every later pool_alloc() and whether
+//  arenas are mlock()ed.  Call once at startup, before any allocation.
+// ---------------------------------------------------------------------------
+void pool_configure(pool_type_t type, bool lock);
+
+// ---------------------------------------------------------------------------
+//  parse_pool_type / pool_type_name
+//  --------------------------------
+//  Convert between POOL_* and "malloc" | "thp" | "hugetlb".
+//  parse_pool_type() returns 0, or -1 for an unknown name.
+// ---------------------------------------------------------------------------
+int         parse_pool_type(const char *str, pool_type_t *type);
+const char *pool_type_name(pool_type_t type);
+
+// ---------------------------------------------------------------------------
+//  pool_alloc
+//  ----------
+//  Returns `size` bytes starting on an `align`-byte boundary (a power of
+//  two; 0 = default malloc alignment), or NULL with errno set.  With
+//  POOL_MALLOC this is plain malloc() / posix_memalign(); otherwise the
+//  memory is prefaulted (and locked, if configured) before it is returned.
+//  Thread-safe.
+// ---------------------------------------------------------------------------
+void *pool_alloc(size_t size, size_t align);
+
+// ---------------------------------------------------------------------------
+//  pool_reserve
+//  ------------
+//  Maps (and prefaults / locks) an arena with at least `bytes` free up
+//  front, so the pool_alloc() calls that follow — e.g. from threads that
+//  have already started their clock — never fault or map anything.
+//  The arena serves threads whose home node is `node` (NUMA_OFF without
+//  --numa).  No-op with POOL_MALLOC.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int pool_reserve(size_t bytes, int node);
+
+// ---------------------------------------------------------------------------
+//  pool_free
+//  ---------
+//  Releases a buffer from pool_alloc().  NULL is ignored.  Thread-safe.
+// ---------------------------------------------------------------------------
+void pool_free(void *ptr);
+
+// ---------------------------------------------------------------------------
+//  pool_report
+//  -----------
+//  Prints one line describing the pool: type, arenas and bytes mapped,
+//  how much of that the kernel backs with huge pages, and any fallbacks
+//  (hugetlb → THP, failed mlock).  Prints nothing for POOL_MALLOC.
+// ---------------------------------------------------------------------------
+void pool_report(const char *tag);
+
+#endif /* MT25082_POOL_H */
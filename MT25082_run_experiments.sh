@@ -26,12 +26,18 @@ set -euo pipefail
 #  Configuration
 # =============================================================================
 
-# Message sizes to test (bytes)
-MSG_SIZES=(64 256 1024 4096)
+# Message sizes to test (bytes; override with e.g. PA02_MSG_SIZES="4096 65536")
+read -r -a MSG_SIZES <<< "${PA02_MSG_SIZES:-64 256 1024 4096}"
 
 # Thread counts to test
 THREAD_COUNTS=(1 2 4 8)
 
+# Scatter degree: fields per message and how msg_size is split across them
+# (uniform | skewed | geometric), passed to both server and client.
+# Sweep with e.g. PA02_FIELD_COUNTS="1 8 64 512" PA02_FIELD_PROFILES="uniform skewed"
+read -r -a FIELD_COUNTS   <<< "${PA02_FIELD_COUNTS:-8}"
+read -r -a FIELD_PROFILES <<< "${PA02_FIELD_PROFILES:-uniform}"
+
 # Duration of each experiment run (seconds)
 DURATION=10
 
@@ -39,6 +45,8 @@ DURATION=10
 PORT_A1=9090
 PORT_A2=9091
 PORT_A3=9092
+PORT_A4=9093
+PORT_A5=9094
 
 # Network namespace names
 NS_SERVER="pa02_server_ns"
@@ -64,25 +72,172 @@ RESULTS_DIR="$SCRIPT_DIR"
 MASTER_CSV="$RESULTS_DIR/MT25082_results.csv"
 
 # perf events to collect
-PERF_EVENTS="cycles,L1-dcache-load-misses,LLC-load-misses,LLC-store-misses,context-switches"
+PERF_EVENTS="cycles,L1-dcache-load-misses,LLC-load-misses,LLC-store-misses,context-switches,dTLB-load-misses,page-faults"
 
 # Implementation labels and binary mappings
 declare -A SERVER_BIN
 SERVER_BIN[A1]="./MT25082_A1_Server"
 SERVER_BIN[A2]="./MT25082_A2_Server"
 SERVER_BIN[A3]="./MT25082_A3_Server"
+SERVER_BIN[A4]="./MT25082_A4_Server"
+SERVER_BIN[A5]="./MT25082_A5_Server"
 
 declare -A CLIENT_BIN
 CLIENT_BIN[A1]="./MT25082_A1_Client"
 CLIENT_BIN[A2]="./MT25082_A2_Client"
 CLIENT_BIN[A3]="./MT25082_A3_Client"
+CLIENT_BIN[A4]="./MT25082_A4_Client"
+CLIENT_BIN[A5]="./MT25082_A5_Client"
 
 declare -A IMPL_PORT
 IMPL_PORT[A1]=$PORT_A1
 IMPL_PORT[A2]=$PORT_A2
 IMPL_PORT[A3]=$PORT_A3
-
-IMPLEMENTATIONS=(A1 A2 A3)
+IMPL_PORT[A4]=$PORT_A4
+IMPL_PORT[A5]=$PORT_A5
+
+IMPLEMENTATIONS=(A1 A2 A3 A4 A5)
+
+# Experiment variants.  Each label maps to an implementation plus extra
+# server (and optionally client) flags; the label is what appears in the
+# CSV "implementation" column and in the per-experiment file names.
+declare -A EXP_IMPL
+declare -A EXP_SERVER_ARGS
+declare -A EXP_CLIENT_ARGS
+# Optional fixed field layout ("S0,S1,..."); replaces the field sweep
+declare -A EXP_LAYOUT
+
+EXP_IMPL[A1]=A1;        EXP_SERVER_ARGS[A1]=""
+EXP_IMPL[A2]=A2;        EXP_SERVER_ARGS[A2]=""
+EXP_IMPL[A3]=A3;        EXP_SERVER_ARGS[A3]=""
+
+# Same send paths driven by the epoll event loop instead of one thread
+# per client (compare against the rows above).
+EXP_IMPL[A1-epoll]=A1;  EXP_SERVER_ARGS[A1-epoll]="--mode epoll"
+EXP_IMPL[A2-epoll]=A2;  EXP_SERVER_ARGS[A2-epoll]="--mode epoll"
+EXP_IMPL[A3-epoll]=A3;  EXP_SERVER_ARGS[A3-epoll]="--mode epoll"
+
+# One SO_REUSEPORT listener + event loop per core, each worker pinned.
+NPROC=$(nproc)
+SHARD_ARGS="--workers ${NPROC} --cpus 0-$((NPROC - 1))"
+EXP_IMPL[A1-sharded]=A1; EXP_SERVER_ARGS[A1-sharded]="$SHARD_ARGS"
+EXP_IMPL[A2-sharded]=A2; EXP_SERVER_ARGS[A2-sharded]="$SHARD_ARGS"
+EXP_IMPL[A3-sharded]=A3; EXP_SERVER_ARGS[A3-sharded]="$SHARD_ARGS"
+
+# A1 still issuing one send() per field, but letting the kernel build full
+# segments with MSG_MORE or TCP_CORK (compare against A1 and A2).
+EXP_IMPL[A1-more]=A1;   EXP_SERVER_ARGS[A1-more]="--coalesce more"
+EXP_IMPL[A1-cork]=A1;   EXP_SERVER_ARGS[A1-cork]="--coalesce cork"
+
+# A2 sending up to 64 messages per sendmsg() (64 KB / 100 µs budgets);
+# compare against A2 at 64 B / 256 B.
+EXP_IMPL[A2-batch]=A2;  EXP_SERVER_ARGS[A2-batch]="--batch 64 --batch-bytes 65536"
+
+# Each message in ONE block instead of one malloc() per field: packed back
+# to back (a single iovec entry), or with every field on a cache-line /
+# page boundary (compare against A1 / A2).
+EXP_IMPL[A1-packed]=A1; EXP_SERVER_ARGS[A1-packed]="--alloc packed"
+EXP_IMPL[A2-packed]=A2; EXP_SERVER_ARGS[A2-packed]="--alloc packed"
+EXP_IMPL[A2-line]=A2;   EXP_SERVER_ARGS[A2-line]="--alloc line"
+EXP_IMPL[A2-page]=A2;   EXP_SERVER_ARGS[A2-page]="--alloc page"
+
+# Message and receive buffers from prefaulted, mlock()ed transparent-huge-
+# page arenas on both ends (compare dTLB misses / page faults against A2 /
+# A3; A3-hugetlb needs vm.nr_hugepages, otherwise it falls back to THP).
+EXP_IMPL[A2-thp]=A2;    EXP_SERVER_ARGS[A2-thp]="--alloc packed --pool thp --mlock"
+EXP_CLIENT_ARGS[A2-thp]="--pool thp --mlock"
+EXP_IMPL[A3-thp]=A3;    EXP_SERVER_ARGS[A3-thp]="--alloc packed --pool thp --mlock"
+EXP_CLIENT_ARGS[A3-thp]="--pool thp --mlock"
+EXP_IMPL[A3-hugetlb]=A3; EXP_SERVER_ARGS[A3-hugetlb]="--alloc packed --pool hugetlb --mlock"
+EXP_CLIENT_ARGS[A3-hugetlb]="--pool hugetlb --mlock"
+
+# Every connection thread and its buffers kept on one NUMA node, nodes used
+# round-robin on both ends (compare LLC misses against A2 / A3 at thread
+# counts above one socket; a no-op on single-node machines).
+EXP_IMPL[A2-numa]=A2;   EXP_SERVER_ARGS[A2-numa]="--numa rr"
+EXP_CLIENT_ARGS[A2-numa]="--numa rr"
+EXP_IMPL[A3-numa]=A3;   EXP_SERVER_ARGS[A3-numa]="--numa rr"
+EXP_CLIENT_ARGS[A3-numa]="--numa rr"
+
+# Each sender / receiver thread started next to the CPU running its
+# socket's receive softirq, and A2 with SCHED_FIFO threads on both ends
+# (compare run-to-run spread against A2).
+EXP_IMPL[A2-rx]=A2;     EXP_SERVER_ARGS[A2-rx]="--cpus rx-next"
+EXP_CLIENT_ARGS[A2-rx]="--cpus rx-next"
+EXP_IMPL[A2-rt]=A2;     EXP_SERVER_ARGS[A2-rt]="--rt 10"
+EXP_CLIENT_ARGS[A2-rt]="--rt 10"
+
+# MSG_ZEROCOPY with a ring of 64 messages, each refreshed per send and
+# reused only after its completion notification (compare against A3).
+EXP_IMPL[A3-ring]=A3;   EXP_SERVER_ARGS[A3-ring]="--ring 64"
+
+# A3 that drops to plain sendmsg() once half of its completions report
+# SO_EE_CODE_ZEROCOPY_COPIED (the usual outcome over veth/loopback).
+EXP_IMPL[A3-fallback]=A3; EXP_SERVER_ARGS[A3-fallback]="--fallback 0.5"
+
+# A3 choosing copy vs MSG_ZEROCOPY per send from a threshold calibrated
+# at start-up (compare against A2 and A3 across all sizes).
+EXP_IMPL[A3-adaptive]=A3; EXP_SERVER_ARGS[A3-adaptive]="--adaptive auto"
+
+# Header + body layout (4 x 16 B headers, the rest in one field): all
+# zero-copy, then headers copied and coalesced with MSG_MORE.
+EXP_IMPL[A3-skewed]=A3; EXP_SERVER_ARGS[A3-skewed]=""
+EXP_IMPL[A3-hybrid]=A3; EXP_SERVER_ARGS[A3-hybrid]="--hybrid 1024"
+EXP_LAYOUT[A3-skewed]="16,16,16,16,*,0,0,0"
+EXP_LAYOUT[A3-hybrid]="16,16,16,16,*,0,0,0"
+
+# io_uring batched SENDMSG at two queue depths (compare against A2).
+EXP_IMPL[A4]=A4;        EXP_SERVER_ARGS[A4]="--qd 8"
+EXP_IMPL[A4-qd32]=A4;   EXP_SERVER_ARGS[A4-qd32]="--qd 32"
+
+# io_uring zero-copy: SEND_ZC on registered buffers and SENDMSG_ZC on the
+# iovec (compare against A3, e.g. with PA02_MSG_SIZES="4096 16384 65536").
+EXP_IMPL[A4-zc]=A4;     EXP_SERVER_ARGS[A4-zc]="--qd 8 --zc fixed"
+EXP_IMPL[A4-zcmsg]=A4;  EXP_SERVER_ARGS[A4-zcmsg]="--qd 8 --zc msg"
+
+# io_uring with a kernel SQ polling thread on the last core: the sender
+# makes ~0 syscalls/msg but spins (compare A2 / A4 at 64 B).
+EXP_IMPL[A4-sqpoll]=A4; EXP_SERVER_ARGS[A4-sqpoll]="--qd 8 --sqpoll $((NPROC - 1))"
+
+# Receive-side zero-copy (TCP_ZEROCOPY_RECEIVE) behind the A2 / A3 servers;
+# A3-zcrx is the end-to-end zero-copy data point.
+EXP_IMPL[A2-zcrx]=A2;   EXP_SERVER_ARGS[A2-zcrx]="";  EXP_CLIENT_ARGS[A2-zcrx]="--recv zerocopy"
+EXP_IMPL[A3-zcrx]=A3;   EXP_SERVER_ARGS[A3-zcrx]="";  EXP_CLIENT_ARGS[A3-zcrx]="--recv zerocopy"
+
+# Receiver rebuilding each message_t: recvmsg() scattered straight into the
+# fields vs recv() into a flat buffer + memcpy() per field (the difference
+# is the second user-space copy; compare cycles and LLC misses).
+EXP_IMPL[A2-scatter]=A2; EXP_SERVER_ARGS[A2-scatter]=""; EXP_CLIENT_ARGS[A2-scatter]="--recv scatter"
+EXP_IMPL[A2-flat]=A2;   EXP_SERVER_ARGS[A2-flat]="";  EXP_CLIENT_ARGS[A2-flat]="--recv flat"
+
+# Receiver reading into a 1 MB ring instead of one message per recv()
+# (compare syscalls and the recv() size histogram against A2 at 64 B).
+EXP_IMPL[A2-ring]=A2;   EXP_SERVER_ARGS[A2-ring]="";  EXP_CLIENT_ARGS[A2-ring]="--recv ring"
+
+# Receiver woken once per message: MSG_WAITALL, and SO_RCVLOWAT + poll()
+# (compare Wakeups/msg against A2 at 4 KB - 1 MB).
+EXP_IMPL[A2-waitall]=A2; EXP_SERVER_ARGS[A2-waitall]=""; EXP_CLIENT_ARGS[A2-waitall]="--recv waitall"
+EXP_IMPL[A2-lowat]=A2;  EXP_SERVER_ARGS[A2-lowat]="";  EXP_CLIENT_ARGS[A2-lowat]="--recv lowat"
+
+# Receiver that drains with recv(MSG_TRUNC) and copies nothing: client
+# cycles / cache misses minus those of A1 / A2 / A3 = the receive copy.
+EXP_IMPL[A1-discard]=A1; EXP_SERVER_ARGS[A1-discard]=""; EXP_CLIENT_ARGS[A1-discard]="--recv discard"
+EXP_IMPL[A2-discard]=A2; EXP_SERVER_ARGS[A2-discard]=""; EXP_CLIENT_ARGS[A2-discard]="--recv discard"
+EXP_IMPL[A3-discard]=A3; EXP_SERVER_ARGS[A3-discard]=""; EXP_CLIENT_ARGS[A3-discard]="--recv discard"
+
+# Receiver that never sleeps for short gaps: user-space spin-then-block
+# (50 us budget) and kernel busy polling (compare wakeups/msg and CPU time
+# against A2; the servers send back to back, so there is no latency to win).
+EXP_IMPL[A2-spin]=A2;   EXP_SERVER_ARGS[A2-spin]="";  EXP_CLIENT_ARGS[A2-spin]="--recv spin --spin 50"
+EXP_IMPL[A2-busypoll]=A2; EXP_SERVER_ARGS[A2-busypoll]=""; EXP_CLIENT_ARGS[A2-busypoll]="--busy-poll 50"
+
+# vmsplice/splice zero-copy (compare against A3 at 4 KB and above).  No
+# --ring: the server sizes each ring to cover SO_SNDBUF plus the client's
+# receive buffer, which is what keeps reuse safe over the veth pair.
+EXP_IMPL[A5]=A5;        EXP_SERVER_ARGS[A5]=""
+
+# Variants to run (override with e.g. PA02_EXPERIMENTS="A2 A2-epoll")
+read -r -a EXPERIMENTS <<< "${PA02_EXPERIMENTS:-A1 A2 A3}"
 
 # Check if perf is actually functional (kernel version must match)
 # Try the default perf first; if it fails (kernel mismatch), search for
@@ -233,6 +388,8 @@ fi
 log "===== PA02 Experiment Runner — MT25082 ====="
 log "Message sizes : ${MSG_SIZES[*]}"
 log "Thread counts : ${THREAD_COUNTS[*]}"
+log "Field counts  : ${FIELD_COUNTS[*]} (${FIELD_PROFILES[*]})"
+log "Experiments   : ${EXPERIMENTS[*]}"
 log "Duration      : ${DURATION}s per experiment"
 if [[ "$PERF_AVAILABLE" == true ]]; then
     log "perf stat    : AVAILABLE ($PERF_CMD)"
@@ -267,111 +424,175 @@ log "Compilation successful."
 setup_namespaces
 
 # ---- Step 4: Write CSV header ---------------------------------------------
-echo "implementation,msg_size,threads,throughput_gbps,latency_us,cycles,L1_cache_misses,LLC_load_misses,LLC_store_misses,context_switches" \
+echo "implementation,msg_size,fields,profile,threads,throughput_gbps,latency_us,cycles,L1_cache_misses,LLC_load_misses,LLC_store_misses,context_switches,dTLB_load_misses,page_faults" \
     > "$MASTER_CSV"
 
 # ---- Step 5: Register cleanup on exit ------------------------------------
 trap 'kill_servers; cleanup_namespaces; log "Cleanup complete."' EXIT
 
 # ---- Step 6: Run experiments ----------------------------------------------
-total_experiments=$(( ${#IMPLEMENTATIONS[@]} * ${#MSG_SIZES[@]} * ${#THREAD_COUNTS[@]} ))
+# Field layouts as "count:profile"; a fixed EXP_LAYOUT list is "0:list"
+# (its length is the field count)
+SWEEP_LAYOUTS=()
+for n_fields in "${FIELD_COUNTS[@]}"; do
+    for profile in "${FIELD_PROFILES[@]}"; do
+        SWEEP_LAYOUTS+=("${n_fields}:${profile}")
+    done
+done
+
+total_experiments=0
+for label in "${EXPERIMENTS[@]}"; do
+    if [[ -n "${EXP_LAYOUT[$label]:-}" ]]; then
+        n_layouts=1
+    else
+        n_layouts=${#SWEEP_LAYOUTS[@]}
+    fi
+    total_experiments=$(( total_experiments +
+                          n_layouts * ${#MSG_SIZES[@]} * ${#THREAD_COUNTS[@]} ))
+done
 current_experiment=0
 
-for impl in "${IMPLEMENTATIONS[@]}"; do
-    for msg_size in "${MSG_SIZES[@]}"; do
-        for threads in "${THREAD_COUNTS[@]}"; do
-            current_experiment=$((current_experiment + 1))
-            port="${IMPL_PORT[$impl]}"
-
-            log "────────────────────────────────────────────────────"
-            log "Experiment ${current_experiment}/${total_experiments}: " \
-                "${impl} | msg_size=${msg_size} | threads=${threads}"
-            log "────────────────────────────────────────────────────"
-
-            # Filenames encode experiment parameters as required
-            perf_file="${RESULTS_DIR}/MT25082_perf_${impl}_sz${msg_size}_t${threads}.txt"
-            client_file="${RESULTS_DIR}/MT25082_client_${impl}_sz${msg_size}_t${threads}.txt"
-
-            # ---- Start server in server namespace ----------------------
-            log "  Starting ${impl} server (port=${port}, msg_size=${msg_size}) …"
-            ip netns exec "$NS_SERVER" \
-                "${SERVER_BIN[$impl]}" "$port" "$msg_size" \
-                > /dev/null 2>&1 &
-            server_pid=$!
-
-            # Give the server time to bind and listen
-            sleep 2
-
-            # Verify server is still running
-            if ! kill -0 "$server_pid" 2>/dev/null; then
-                log "  WARNING: Server failed to start, skipping …"
+for label in "${EXPERIMENTS[@]}"; do
+    if [[ -z "${EXP_IMPL[$label]:-}" ]]; then
+        log "Unknown experiment '${label}', skipping …"
+        continue
+    fi
+    impl="${EXP_IMPL[$label]}"
+    read -r -a server_args <<< "${EXP_SERVER_ARGS[$label]}"
+    read -r -a client_args <<< "${EXP_CLIENT_ARGS[$label]:-}"
+
+    if [[ -n "${EXP_LAYOUT[$label]:-}" ]]; then
+        layouts=("0:${EXP_LAYOUT[$label]}")
+    else
+        layouts=("${SWEEP_LAYOUTS[@]}")
+    fi
+
+    for layout in "${layouts[@]}"; do
+        n_fields="${layout%%:*}"
+        profile="${layout#*:}"
+        if [[ "$n_fields" == 0 ]]; then
+            layout_args=(--profile "$profile")
+            n_fields=$(( $(tr -cd ',' <<< "$profile" | wc -c) + 1 ))
+            layout_tag="f${n_fields}custom"
+        else
+            layout_args=(--nfields "$n_fields" --profile "$profile")
+            layout_tag="f${n_fields}${profile}"
+        fi
+
+        for msg_size in "${MSG_SIZES[@]}"; do
+            for threads in "${THREAD_COUNTS[@]}"; do
+                current_experiment=$((current_experiment + 1))
+                port="${IMPL_PORT[$impl]}"
+
+                log "────────────────────────────────────────────────────"
+                log "Experiment ${current_experiment}/${total_experiments}: " \
+                    "${label} | msg_size=${msg_size} | fields=${n_fields} (${profile}) | threads=${threads}"
+                log "────────────────────────────────────────────────────"
+
+                # Filenames encode experiment parameters as required
+                perf_file="${RESULTS_DIR}/MT25082_perf_${label}_sz${msg_size}_${layout_tag}_t${threads}.txt"
+                client_file="${RESULTS_DIR}/MT25082_client_${label}_sz${msg_size}_${layout_tag}_t${threads}.txt"
+
+                # ---- Start server in server namespace ----------------------
+                log "  Starting ${label} server (port=${port}, msg_size=${msg_size}) …"
+                ip netns exec "$NS_SERVER" \
+                    "${SERVER_BIN[$impl]}" "${layout_args[@]}" \
+                        ${server_args[@]+"${server_args[@]}"} "$port" "$msg_size" \
+                    > /dev/null 2>&1 &
+                server_pid=$!
+
+                # Give the server time to bind and listen (A3 --adaptive auto
+                # benchmarks for about a second before it starts listening)
+                for _ in $(seq 1 20); do
+                    if ip netns exec "$NS_SERVER" ss -Hltn "sport = :${port}" \
+                            2>/dev/null | grep -q .; then
+                        break
+                    fi
+                    sleep 0.5
+                done
+
+                # Verify server is still running
+                if ! kill -0 "$server_pid" 2>/dev/null; then
+                    log "  WARNING: Server failed to start, skipping …"
+                    wait "$server_pid" 2>/dev/null || true
+                    continue
+                fi
+
+                # ---- Run client with perf stat in client namespace ---------
+                #
+                # perf stat wraps the client process and collects hardware
+                # performance counters for the entire client execution:
+                #   • cycles           — total CPU cycles consumed
+                #   • L1-dcache-load-misses — L1 data cache misses
+                #   • LLC-load-misses  — Last-Level Cache load misses
+                #   • LLC-store-misses — Last-Level Cache store misses
+                #   • context-switches — voluntary + involuntary CS
+                #   • dTLB-load-misses — data TLB misses (see --pool)
+                #   • page-faults      — includes first-touch faults
+                #
+                # The -e flag specifies which events to monitor.
+                # perf output goes to stderr → redirected to perf_file.
+                # Client stdout (throughput, latency) → client_file.
+                log "  Running ${impl} client (threads=${threads}, duration=${DURATION}s) …"
+                if [[ "$PERF_AVAILABLE" == true ]]; then
+                    # Run with perf stat to collect hardware counters
+                    ip netns exec "$NS_CLIENT" \
+                        "$PERF_CMD" stat -e "$PERF_EVENTS" \
+                        "${CLIENT_BIN[$impl]}" "${layout_args[@]}" \
+                            ${client_args[@]+"${client_args[@]}"} \
+                            "$IP_SERVER" "$port" "$msg_size" \
+                            "$threads" "$DURATION" \
+                        > "$client_file" 2> "$perf_file" || true
+                else
+                    # Run without perf — collect app-level metrics only
+                    ip netns exec "$NS_CLIENT" \
+                        "${CLIENT_BIN[$impl]}" "${layout_args[@]}" \
+                            ${client_args[@]+"${client_args[@]}"} \
+                            "$IP_SERVER" "$port" "$msg_size" \
+                            "$threads" "$DURATION" \
+                        > "$client_file" 2>&1 || true
+                    # Create empty perf file so parsing doesn't fail
+                    echo "(perf not available)" > "$perf_file"
+                fi
+
+                # ---- Stop the server ---------------------------------------
+                log "  Stopping server (pid=${server_pid}) …"
+                kill "$server_pid" 2>/dev/null || true
                 wait "$server_pid" 2>/dev/null || true
-                continue
-            fi
-
-            # ---- Run client with perf stat in client namespace ---------
-            #
-            # perf stat wraps the client process and collects hardware
-            # performance counters for the entire client execution:
-            #   • cycles           — total CPU cycles consumed
-            #   • L1-dcache-load-misses — L1 data cache misses
-            #   • LLC-load-misses  — Last-Level Cache load misses
-            #   • LLC-store-misses — Last-Level Cache store misses
-            #   • context-switches — voluntary + involuntary CS
-            #
-            # The -e flag specifies which events to monitor.
-            # perf output goes to stderr → redirected to perf_file.
-            # Client stdout (throughput, latency) → client_file.
-            log "  Running ${impl} client (threads=${threads}, duration=${DURATION}s) …"
-            if [[ "$PERF_AVAILABLE" == true ]]; then
-                # Run with perf stat to collect hardware counters
-                ip netns exec "$NS_CLIENT" \
-                    "$PERF_CMD" stat -e "$PERF_EVENTS" \
-                    "${CLIENT_BIN[$impl]}" "$IP_SERVER" "$port" "$msg_size" \
-                        "$threads" "$DURATION" \
-                    > "$client_file" 2> "$perf_file" || true
-            else
-                # Run without perf — collect app-level metrics only
-                ip netns exec "$NS_CLIENT" \
-                    "${CLIENT_BIN[$impl]}" "$IP_SERVER" "$port" "$msg_size" \
-                        "$threads" "$DURATION" \
-                    > "$client_file" 2>&1 || true
-                # Create empty perf file so parsing doesn't fail
-                echo "(perf not available)" > "$perf_file"
-            fi
-
-            # ---- Stop the server ---------------------------------------
-            log "  Stopping server (pid=${server_pid}) …"
-            kill "$server_pid" 2>/dev/null || true
-            wait "$server_pid" 2>/dev/null || true
-            sleep 1
-
-            # ---- Parse results -----------------------------------------
-            throughput=$(parse_client_output "$client_file" "throughput")
-            latency=$(parse_client_output "$client_file" "latency")
-            cycles=$(parse_perf_output "$perf_file" "cycles")
-            l1_misses=$(parse_perf_output "$perf_file" "L1-dcache-load-misses")
-            llc_load_misses=$(parse_perf_output "$perf_file" "LLC-load-misses")
-            llc_store_misses=$(parse_perf_output "$perf_file" "LLC-store-misses")
-            ctx_switches=$(parse_perf_output "$perf_file" "context-switches")
-
-            # Default to 0 for any missing values
-            throughput="${throughput:-0}"
-            latency="${latency:-0}"
-            cycles="${cycles:-0}"
-            l1_misses="${l1_misses:-0}"
-            llc_load_misses="${llc_load_misses:-0}"
-            llc_store_misses="${llc_store_misses:-0}"
-            ctx_switches="${ctx_switches:-0}"
-
-            # ---- Append to master CSV ----------------------------------
-            echo "${impl},${msg_size},${threads},${throughput},${latency},${cycles},${l1_misses},${llc_load_misses},${llc_store_misses},${ctx_switches}" \
-                >> "$MASTER_CSV"
-
-            log "  Results: throughput=${throughput} Gbps, " \
-                "latency=${latency} µs, cycles=${cycles}, " \
-                "L1_misses=${l1_misses}, LLC_load=${llc_load_misses}, " \
-                "ctx_sw=${ctx_switches}"
+                sleep 1
+
+                # ---- Parse results -----------------------------------------
+                throughput=$(parse_client_output "$client_file" "throughput")
+                latency=$(parse_client_output "$client_file" "latency")
+                cycles=$(parse_perf_output "$perf_file" "cycles")
+                l1_misses=$(parse_perf_output "$perf_file" "L1-dcache-load-misses")
+                llc_load_misses=$(parse_perf_output "$perf_file" "LLC-load-misses")
+                llc_store_misses=$(parse_perf_output "$perf_file" "LLC-store-misses")
+                ctx_switches=$(parse_perf_output "$perf_file" "context-switches")
+                dtlb_misses=$(parse_perf_output "$perf_file" "dTLB-load-misses")
+                page_faults=$(parse_perf_output "$perf_file" "page-faults")
+
+                # Default to 0 for any missing values
+                throughput="${throughput:-0}"
+                latency="${latency:-0}"
+                cycles="${cycles:-0}"
+                l1_misses="${l1_misses:-0}"
+                llc_load_misses="${llc_load_misses:-0}"
+                llc_store_misses="${llc_store_misses:-0}"
+                ctx_switches="${ctx_switches:-0}"
+                dtlb_misses="${dtlb_misses:-0}"
+                page_faults="${page_faults:-0}"
+
+                # ---- Append to master CSV (explicit field lists use "/") ----
+                echo "${label},${msg_size},${n_fields},${profile//,//},${threads},${throughput},${latency},${cycles},${l1_misses},${llc_load_misses},${llc_store_misses},${ctx_switches},${dtlb_misses},${page_faults}" \
+                    >> "$MASTER_CSV"
+
+                log "  Results: throughput=${throughput} Gbps, " \
+                    "latency=${latency} µs, cycles=${cycles}, " \
+                    "L1_misses=${l1_misses}, LLC_load=${llc_load_misses}, " \
+                    "ctx_sw=${ctx_switches}, dTLB=${dtlb_misses}, " \
+                    "faults=${page_faults}"
+            done
         done
     done
 done
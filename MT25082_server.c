@@ -0,0 +1,1043 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_server.c
+// Purpose: Implements the shared server runtime declared in MT25082_server.h:
+//          command-line parsing, the listening socket(s), and the
+//          concurrency models (thread-per-client, epoll event loop, and
+//          SO_REUSEPORT-sharded event-loop workers) that drive each
+//          server's per-connection send state machine.
+//
+// Event-loop design notes:
+//   • Accepted sockets are made non-blocking (accept4 + SOCK_NONBLOCK) and
+//     registered with EPOLLOUT | EPOLLET.  Edge-triggered mode means we
+//     are woken once per "became writable" transition, so on every wakeup
+//     the connection is pumped until step() reports CONN_BLOCKED (EAGAIN).
+//   • The listening socket is registered level-triggered; on each wakeup
+//     we accept until EAGAIN so bursts of connections are not starved.
+//   • EPOLLERR is always reported by epoll.  For A3 it signals that
+//     MSG_ZEROCOPY completions are waiting on the error queue, so the
+//     runtime hands it to conn_ops_t::on_error before pumping again.
+//
+// Sharded-worker design notes:
+//   • Every worker binds its own listening socket to the same port with
+//     SO_REUSEPORT.  The kernel hashes each incoming connection's 4-tuple
+//     to one of the listeners, so accepts, connection state and sends all
+//     stay on the worker (and, with --cpus, on the core) that owns it.
+//   • Workers run with SIGINT blocked.  The main thread waits for the
+//     signal in sigsuspend() and then wakes every loop through a shared
+//     eventfd registered in each worker's epoll set.
+//
+// NUMA notes (--numa):
+//   • The unit that owns buffers is placed: each connection thread in
+//     thread mode, each worker with --workers, the single loop thread in
+//     epoll mode (which therefore only accepts a fixed node).
+//   • Placement happens before open(), so the message buffers and the
+//     socket's kernel memory are allocated from the thread's node; the
+//     runtime then reports where the buffers actually landed.
+//
+// CPU placement notes (--cpus, --rt):
+//   • LIST pins connection threads (thread mode), workers (sharded) or
+//     the loop thread (epoll, first CPU) round-robin over the list.  A
+//     pinned worker also sets SO_INCOMING_CPU on its listener, so the
+//     SO_REUSEPORT lookup prefers the worker on the CPU that took the SYN.
+//   • rx / rx-next (thread mode) read SO_INCOMING_CPU right after accept
+//     and start the connection thread on, or next to, that CPU.
+//   • Every connection logs the CPU its thread ended on and the socket's
+//     last receive CPU when it closes, so a good placement can be
+//     reproduced with an explicit LIST.
+// =============================================================================
+
+#define _GNU_SOURCE             /* accept4, SOCK_NONBLOCK                    */
+
+#include "MT25082_server.h"
+
+#include <fcntl.h>              /* fcntl, O_NONBLOCK                         */
+#include <sys/epoll.h>          /* epoll_create1, epoll_ctl, epoll_wait      */
+#include <sys/eventfd.h>        /* eventfd (worker shutdown notification)    */
+
+volatile sig_atomic_t g_running = 1;
+
+// ---------------------------------------------------------------------------
+//  SIGINT handler — sets the flag so accept() / send() loops exit cleanly.
+// ---------------------------------------------------------------------------
+static void sigint_handler(int signo)
+{
+    (void)signo;
+    g_running = 0;
+}
+
+// ===========================================================================
+//  conn_slot_t
+// ===========================================================================
+//  Runtime bookkeeping for one accepted connection.  In thread mode a slot
+//  is the heap-allocated argument of the connection thread; in epoll mode
+//  it is stored in epoll_event.data.ptr and linked into a list so every
+//  live connection can be closed on shutdown.
+// ---------------------------------------------------------------------------
+typedef struct conn_slot {
+    int                  fd;        /* Connected socket                      */
+    void                *conn;      /* Server-specific state from open()     */
+    const conn_ops_t    *ops;       /* Send logic                            */
+    const server_opts_t *opts;      /* Parsed command line                   */
+    int                  node;      /* --numa node (thread mode) or NUMA_OFF */
+    int                  cpu;       /* --cpus CPU (thread mode), or -1       */
+    struct conn_slot    *prev;      /* Live-connection list (epoll mode)     */
+    struct conn_slot    *next;
+} conn_slot_t;
+
+/* Address used as epoll_event.data.ptr for the shutdown eventfd */
+static char g_stop_marker;
+
+// ===========================================================================
+//  usage
+// ===========================================================================
+static void usage(const char *prog, const conn_ops_t *ops)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <port> <message_size_bytes>\n"
+            "Options:\n"
+            "  -m, --mode thread|epoll   concurrency model (default: thread)\n"
+            "  -w, --workers N           N SO_REUSEPORT listeners, one epoll\n"
+            "                            loop per worker thread\n"
+            "  -c, --cpus LIST|rx|rx-next\n"
+            "                            pin connection thread / worker i to\n"
+            "                            the i-th CPU of LIST (cpulist syntax,\n"
+            "                            e.g. 0-3,8; epoll: first CPU), or each\n"
+            "                            connection to its SO_INCOMING_CPU (rx)\n"
+            "                            or the next CPU on its node (rx-next,\n"
+            "                            thread mode)\n"
+            "  -R, --rt PRIO             run send threads SCHED_FIFO at PRIO\n"
+            "                            (1-99; needs CAP_SYS_NICE)\n"
+            "  -n, --nfields N           fields per message, 1..%d "
+            "(default: %d)\n"
+            "  -p, --profile P           field sizes: uniform | skewed | "
+            "geometric |\n"
+            "                            S0,S1,... (one may be '*' = rest)\n"
+            "  -A, --alloc A             field memory: scatter (one malloc per\n"
+            "                            field, default) | packed | line | page\n"
+            "                            (one block, fields back to back or\n"
+            "                            aligned to a cache line / page)\n"
+            "  -P, --pool malloc|thp|hugetlb\n"
+            "                            message memory: malloc (default), or\n"
+            "                            prefaulted huge-page arenas\n"
+            "  -L, --mlock               mlock() the --pool arenas\n"
+            "  -N, --numa rr|NODE        run each connection (thread mode) or\n"
+            "                            worker on one NUMA node and place its\n"
+            "                            buffers there; rr = round-robin over\n"
+            "                            nodes (not with --mode epoll)\n",
+            prog, MAX_FIELDS, NUM_FIELDS);
+    if (ops->extra_usage != NULL) {
+        fputs(ops->extra_usage, stderr);
+    }
+}
+
+// ===========================================================================
+//  parse_args
+// ===========================================================================
+//  Fills *opts from argv.  Returns 0 on success, -1 on invalid input (a
+//  diagnostic has already been printed).
+// ---------------------------------------------------------------------------
+static int parse_args(int argc, char *argv[], const conn_ops_t *ops,
+                      server_opts_t *opts)
+{
+    static const struct option common_opts[] = {
+        { "mode",    required_argument, NULL, 'm' },
+        { "workers", required_argument, NULL, 'w' },
+        { "cpus",    required_argument, NULL, 'c' },
+        { "nfields", required_argument, NULL, 'n' },
+        { "profile", required_argument, NULL, 'p' },
+        { "alloc",   required_argument, NULL, 'A' },
+        { "pool",    required_argument, NULL, 'P' },
+        { "mlock",   no_argument,       NULL, 'L' },
+        { "numa",    required_argument, NULL, 'N' },
+        { "rt",      required_argument, NULL, 'R' },
+        { NULL,      0,                 NULL,  0  }
+    };
+    static const char common_short[] = "m:w:c:n:p:A:P:LN:R:";
+
+    /* ---- Merge the common and server-specific option tables ----------- */
+    struct option long_opts[MAX_SERVER_OPTS];
+    char          short_opts[2 * MAX_SERVER_OPTS + sizeof(common_short)];
+    int           n = 0;
+
+    for (const struct option *o = common_opts; o->name != NULL; o++) {
+        long_opts[n++] = *o;
+    }
+    for (const struct option *o = ops->extra_opts;
+         o != NULL && o->name != NULL && n < MAX_SERVER_OPTS - 1; o++) {
+        long_opts[n++] = *o;
+    }
+    memset(&long_opts[n], 0, sizeof(long_opts[n]));
+
+    snprintf(short_opts, sizeof(short_opts), "%s%s", common_short,
+             ops->extra_short != NULL ? ops->extra_short : "");
+
+    memset(opts, 0, sizeof(*opts));
+    opts->mode    = SERVER_MODE_THREAD;
+    opts->profile = "uniform";
+    opts->numa    = NUMA_OFF;
+    numa_discover();
+
+    int n_fields = 0;
+    int c;
+    while ((c = getopt_long(argc, argv, short_opts, long_opts, NULL)) != -1) {
+        switch (c) {
+        case 'm':
+            if (strcmp(optarg, "thread") == 0) {
+                opts->mode = SERVER_MODE_THREAD;
+            } else if (strcmp(optarg, "epoll") == 0) {
+                opts->mode = SERVER_MODE_EPOLL;
+            } else {
+                fprintf(stderr, "%s Unknown mode: %s\n", ops->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'w':
+            opts->workers = atoi(optarg);
+            if (opts->workers <= 0) {
+                fprintf(stderr, "%s Worker count must be > 0\n", ops->tag);
+                return -1;
+            }
+            break;
+        case 'c':
+            opts->n_cpus = parse_cpu_pin(optarg, &opts->pin, opts->cpus,
+                                         MAX_CPUS);
+            if (opts->n_cpus < 0) {
+                fprintf(stderr, "%s Invalid CPU list: %s\n", ops->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'R':
+            opts->rt_prio = atoi(optarg);
+            if (opts->rt_prio < 1 || opts->rt_prio > 99) {
+                fprintf(stderr, "%s --rt priority must be 1..99\n", ops->tag);
+                return -1;
+            }
+            break;
+        case 'n':
+            n_fields = atoi(optarg);
+            if (n_fields < 1 || n_fields > MAX_FIELDS) {
+                fprintf(stderr, "%s Field count must be 1..%d\n",
+                        ops->tag, MAX_FIELDS);
+                return -1;
+            }
+            break;
+        case 'p':
+            opts->profile = optarg;
+            break;
+        case 'A':
+            if (parse_msg_alloc(optarg, &opts->alloc) < 0) {
+                fprintf(stderr, "%s Unknown allocation: %s\n",
+                        ops->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'P':
+            if (parse_pool_type(optarg, &opts->pool) < 0) {
+                fprintf(stderr, "%s Unknown pool: %s\n", ops->tag, optarg);
+                return -1;
+            }
+            break;
+        case 'L':
+            opts->mlock = true;
+            break;
+        case 'N':
+            if (parse_numa_policy(optarg, &opts->numa) < 0) {
+                fprintf(stderr, "%s --numa: '%s' is not rr or an online "
+                        "node\n", ops->tag, optarg);
+                return -1;
+            }
+            break;
+        case '?':
+            usage(argv[0], ops);
+            return -1;
+        default:
+            if (ops->parse_opt == NULL || ops->parse_opt(c, optarg) < 0) {
+                usage(argv[0], ops);
+                return -1;
+            }
+            break;
+        }
+    }
+
+    if (argc - optind != 2) {
+        usage(argv[0], ops);
+        return -1;
+    }
+
+    /* --workers selects the sharded model regardless of --mode */
+    if (opts->workers > 0) {
+        opts->mode = SERVER_MODE_SHARDED;
+    }
+    if ((opts->pin == CPU_PIN_RX || opts->pin == CPU_PIN_RX_NEXT) &&
+        opts->mode != SERVER_MODE_THREAD) {
+        fprintf(stderr, "%s --cpus rx|rx-next needs --mode thread (a loop "
+                "serves connections from many CPUs)\n", ops->tag);
+        return -1;
+    }
+
+    if (opts->mlock && opts->pool == POOL_MALLOC) {
+        fprintf(stderr, "%s --mlock requires --pool thp|hugetlb\n", ops->tag);
+        return -1;
+    }
+
+    if (opts->numa == NUMA_RR && opts->mode == SERVER_MODE_EPOLL) {
+        fprintf(stderr, "%s --numa rr needs --mode thread or --workers "
+                "(one epoll loop runs on one node)\n", ops->tag);
+        return -1;
+    }
+
+    if (ops->thread_only && opts->mode != SERVER_MODE_THREAD) {
+        fprintf(stderr, "%s This server only supports --mode thread\n",
+                ops->tag);
+        return -1;
+    }
+
+    opts->port     = atoi(argv[optind]);
+    opts->msg_size = (size_t)atol(argv[optind + 1]);
+
+    if (opts->port <= 0 || opts->port > 65535) {
+        fprintf(stderr, "%s Invalid port: %d\n", ops->tag, opts->port);
+        return -1;
+    }
+    if (opts->msg_size == 0) {
+        fprintf(stderr, "%s Message size must be > 0\n", ops->tag);
+        return -1;
+    }
+    if (message_layout(&opts->layout, opts->msg_size, n_fields,
+                       opts->profile) < 0) {
+        fprintf(stderr, "%s Invalid field layout '%s' for %zu bytes "
+                "(uniform | skewed | geometric, or sizes adding up to "
+                "%zu; a list sets --nfields itself)\n", ops->tag,
+                opts->profile, opts->msg_size, opts->msg_size);
+        return -1;
+    }
+    return 0;
+}
+
+// ===========================================================================
+//  open_listener
+// ===========================================================================
+//  Creates, binds and listens on a TCP socket.  With `reuseport` the
+//  socket joins the port's SO_REUSEPORT group so several workers can each
+//  own a listener on the same port.  Returns the fd, or -1.
+// ---------------------------------------------------------------------------
+static int open_listener(const conn_ops_t *ops, const server_opts_t *opts,
+                         bool reuseport)
+{
+    int listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        fprintf(stderr, "%s socket: %s\n", ops->tag, strerror(errno));
+        return -1;
+    }
+
+    /* Allow immediate port reuse after restart */
+    int opt = 1;
+    if (setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        fprintf(stderr, "%s setsockopt SO_REUSEADDR: %s\n",
+                ops->tag, strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
+
+    if (reuseport &&
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        fprintf(stderr, "%s setsockopt SO_REUSEPORT: %s\n",
+                ops->tag, strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
+
+    struct sockaddr_in serv_addr;
+    memset(&serv_addr, 0, sizeof(serv_addr));
+    serv_addr.sin_family      = AF_INET;
+    serv_addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    serv_addr.sin_port        = htons((uint16_t)opts->port);
+
+    if (bind(listen_fd, (struct sockaddr *)&serv_addr, sizeof(serv_addr)) < 0) {
+        fprintf(stderr, "%s bind: %s\n", ops->tag, strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
+
+    if (listen(listen_fd, BACKLOG) < 0) {
+        fprintf(stderr, "%s listen: %s\n", ops->tag, strerror(errno));
+        close(listen_fd);
+        return -1;
+    }
+
+    return listen_fd;
+}
+
+// ===========================================================================
+//  log_accept
+// ===========================================================================
+//  Prints the peer address and disables Nagle on a freshly accepted socket.
+// ---------------------------------------------------------------------------
+static void log_accept(const conn_ops_t *ops, int client_fd,
+                       const struct sockaddr_in *client_addr)
+{
+    printf("%s Accepted connection from %s:%d (fd=%d)\n",
+           ops->tag,
+           inet_ntoa(client_addr->sin_addr),
+           ntohs(client_addr->sin_port),
+           client_fd);
+
+    /* Disable Nagle's algorithm for lower latency measurements */
+    int flag = 1;
+    setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+}
+
+// ===========================================================================
+//  NUMA placement
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  numa_enter
+//  ----------
+//  Moves the calling thread (unless `pinned`, i.e. already on a CPU of
+//  its choosing) and its memory policy to `node`.  Failures are reported
+//  and the thread carries on unplaced.
+// ---------------------------------------------------------------------------
+static void numa_enter(const conn_ops_t *ops, int node, bool pinned)
+{
+    if (!pinned && numa_run_on(node) < 0) {
+        fprintf(stderr, "%s NUMA node %d: affinity: %s\n",
+                ops->tag, node, strerror(errno));
+    }
+    if (numa_bind_memory(node) < 0) {
+        fprintf(stderr, "%s NUMA node %d: set_mempolicy: %s\n",
+                ops->tag, node, strerror(errno));
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  enter_rt
+//  --------
+//  Applies --rt to the calling thread.  A refusal is reported once, not
+//  once per connection.
+// ---------------------------------------------------------------------------
+static void enter_rt(const conn_ops_t *ops, int prio)
+{
+    static bool warned = false;
+
+    if (prio > 0 && set_thread_fifo(prio) < 0 &&
+        !__atomic_exchange_n(&warned, true, __ATOMIC_RELAXED)) {
+        fprintf(stderr, "%s SCHED_FIFO %d: %s — threads keep the normal "
+                "policy\n", ops->tag, prio, strerror(errno));
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  log_cpus
+//  --------
+//  Records where a connection ended up: the CPU its (last) serving thread
+//  ran on and the CPU that last processed its incoming packets.  Must be
+//  called on the serving thread, before close() releases the socket.
+// ---------------------------------------------------------------------------
+static void log_cpus(const conn_ops_t *ops, int fd)
+{
+    printf("%s Connection fd=%d: final CPU %d, rx CPU %d\n",
+           ops->tag, fd, sched_getcpu(), socket_rx_cpu(fd));
+}
+
+// ---------------------------------------------------------------------------
+//  log_placement
+//  -------------
+//  Reports where the buffers just allocated by open() live.  Only called
+//  on threads with a home node, after numa_track_reset() + open().
+// ---------------------------------------------------------------------------
+static void log_placement(const conn_ops_t *ops, int fd)
+{
+    char where[128];
+    numa_track_report(where, sizeof(where));
+    printf("%s Connection fd=%d on node %d: buffers %s\n",
+           ops->tag, fd, numa_thread_node(), where);
+}
+
+// ===========================================================================
+//  Thread-per-client model
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  conn_thread
+//  -----------
+//  Thread entry point.  The connection state is opened inside the thread
+//  so its message buffers are first-touched by the CPU that sends them.
+//  The blocking socket makes step() sleep in the kernel whenever the send
+//  buffer is full, exactly like the original per-server client_handler.
+// ---------------------------------------------------------------------------
+static void *conn_thread(void *arg)
+{
+    conn_slot_t *slot = (conn_slot_t *)arg;
+    const conn_ops_t *ops = slot->ops;
+    int fd = slot->fd;
+
+    if (slot->cpu >= 0 && pin_thread_to_cpu(slot->cpu) < 0) {
+        fprintf(stderr, "%s fd=%d: cannot pin to CPU %d: %s\n",
+                ops->tag, fd, slot->cpu, strerror(errno));
+    }
+    if (slot->node != NUMA_OFF) {
+        numa_enter(ops, slot->node, slot->cpu >= 0);
+        numa_track_reset();
+    }
+    enter_rt(ops, slot->opts->rt_prio);
+
+    void *conn = ops->open(fd, slot->opts, false);
+    if (conn == NULL) {
+        close(fd);
+        free(slot);
+        return NULL;
+    }
+    if (slot->node != NUMA_OFF) {
+        log_placement(ops, fd);
+    }
+    free(slot);   /* Heap-allocated by accept loop; thread owns lifetime */
+
+    while (g_running) {
+        if (ops->step(conn) == CONN_CLOSED) {
+            break;
+        }
+    }
+
+    log_cpus(ops, fd);
+    ops->close(conn);
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+//  run_thread_per_client
+//  ---------------------
+//  Accept loop: one detached pthread per client.  The n-th connection is
+//  pinned to the n-th CPU of a --cpus list, or to / next to its
+//  SO_INCOMING_CPU; otherwise --numa rr sends it to the n-th node.
+// ---------------------------------------------------------------------------
+static void run_thread_per_client(int listen_fd, const conn_ops_t *ops,
+                                  const server_opts_t *opts)
+{
+    int n_accepted = 0;
+
+    while (g_running) {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+
+        int client_fd = accept(listen_fd,
+                               (struct sockaddr *)&client_addr,
+                               &addr_len);
+
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;   /* accept() interrupted by SIGINT */
+            }
+            fprintf(stderr, "%s accept: %s\n", ops->tag, strerror(errno));
+            continue;
+        }
+
+        log_accept(ops, client_fd, &client_addr);
+
+        conn_slot_t *slot = (conn_slot_t *)calloc(1, sizeof(conn_slot_t));
+        if (slot == NULL) {
+            fprintf(stderr, "%s malloc conn_slot: %s\n",
+                    ops->tag, strerror(errno));
+            close(client_fd);
+            continue;
+        }
+        slot->fd   = client_fd;
+        slot->ops  = ops;
+        slot->opts = opts;
+        slot->cpu  = -1;
+        if (opts->pin == CPU_PIN_LIST) {
+            slot->cpu = opts->cpus[n_accepted % opts->n_cpus];
+        } else if (opts->pin != CPU_PIN_NONE) {
+            slot->cpu = rx_pin_cpu(socket_rx_cpu(client_fd), opts->pin);
+        }
+        slot->node = (opts->numa == NUMA_OFF || slot->cpu < 0)
+                         ? numa_pick(opts->numa, n_accepted)
+                         : numa_cpu_node(slot->cpu);
+        n_accepted++;
+
+        pthread_t tid;
+        if (pthread_create(&tid, NULL, conn_thread, slot) != 0) {
+            fprintf(stderr, "%s pthread_create failed\n", ops->tag);
+            free(slot);
+            close(client_fd);
+            continue;
+        }
+        pthread_detach(tid);
+    }
+}
+
+// ===========================================================================
+//  Epoll event-loop model
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  close_slot
+//  ----------
+//  Deregisters a connection, unlinks it and lets the server report and
+//  release its state.
+// ---------------------------------------------------------------------------
+static void close_slot(int epfd, conn_slot_t **head, conn_slot_t *slot)
+{
+    epoll_ctl(epfd, EPOLL_CTL_DEL, slot->fd, NULL);
+    log_cpus(slot->ops, slot->fd);
+
+    if (slot->prev != NULL) {
+        slot->prev->next = slot->next;
+    } else {
+        *head = slot->next;
+    }
+    if (slot->next != NULL) {
+        slot->next->prev = slot->prev;
+    }
+
+    slot->ops->close(slot->conn);   /* Closes slot->fd */
+    free(slot);
+}
+
+// ---------------------------------------------------------------------------
+//  accept_pending
+//  --------------
+//  Accepts every queued connection and registers it edge-triggered.
+// ---------------------------------------------------------------------------
+static void accept_pending(int epfd, int listen_fd, conn_slot_t **head,
+                           size_t *accepted,
+                           const conn_ops_t *ops, const server_opts_t *opts)
+{
+    while (g_running) {
+        struct sockaddr_in client_addr;
+        socklen_t addr_len = sizeof(client_addr);
+
+        int client_fd = accept4(listen_fd,
+                                (struct sockaddr *)&client_addr,
+                                &addr_len, SOCK_NONBLOCK);
+        if (client_fd < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                fprintf(stderr, "%s accept4: %s\n", ops->tag, strerror(errno));
+            }
+            return;
+        }
+
+        log_accept(ops, client_fd, &client_addr);
+
+        conn_slot_t *slot = (conn_slot_t *)calloc(1, sizeof(conn_slot_t));
+        if (slot == NULL) {
+            fprintf(stderr, "%s malloc conn_slot: %s\n",
+                    ops->tag, strerror(errno));
+            close(client_fd);
+            continue;
+        }
+        slot->fd   = client_fd;
+        slot->ops  = ops;
+        slot->opts = opts;
+        slot->node = numa_thread_node();
+        if (slot->node != NUMA_OFF) {
+            numa_track_reset();
+        }
+        slot->conn = ops->open(client_fd, opts, true);
+        if (slot->conn == NULL) {
+            close(client_fd);
+            free(slot);
+            continue;
+        }
+        if (slot->node != NUMA_OFF) {
+            log_placement(ops, client_fd);
+        }
+
+        /*
+         * A socket that is already writable when added with EPOLLET
+         * produces one initial event, so the first pump happens on the
+         * next epoll_wait() without an explicit kick here.
+         */
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events   = EPOLLOUT | EPOLLET;
+        ev.data.ptr = slot;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, client_fd, &ev) < 0) {
+            fprintf(stderr, "%s epoll_ctl ADD: %s\n", ops->tag, strerror(errno));
+            ops->close(slot->conn);
+            free(slot);
+            continue;
+        }
+
+        slot->next = *head;
+        if (*head != NULL) {
+            (*head)->prev = slot;
+        }
+        *head = slot;
+        (*accepted)++;
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  service_slot
+//  ------------
+//  Handles one readiness event: drains the error queue if flagged, then
+//  pumps the state machine until it blocks.  Returns CONN_CLOSED if the
+//  connection must be torn down.
+// ---------------------------------------------------------------------------
+static conn_status_t service_slot(conn_slot_t *slot, uint32_t events)
+{
+    const conn_ops_t *ops = slot->ops;
+    conn_status_t st;
+
+    if ((events & EPOLLERR) && ops->on_error != NULL) {
+        if (ops->on_error(slot->conn) == CONN_CLOSED) {
+            return CONN_CLOSED;
+        }
+    }
+
+    do {
+        st = ops->step(slot->conn);
+    } while (st == CONN_PROGRESS && g_running);
+
+    return st;
+}
+
+// ---------------------------------------------------------------------------
+//  run_event_loop
+//  --------------
+//  Single-threaded epoll loop serving one listener and its connections.
+//  `stop_fd` (-1 if unused) is an eventfd that ends the loop when written;
+//  without it the loop relies on SIGINT interrupting epoll_wait().
+//
+//  Returns:
+//      Number of connections accepted by this loop.
+// ---------------------------------------------------------------------------
+static size_t run_event_loop(int listen_fd, int stop_fd, const conn_ops_t *ops,
+                             const server_opts_t *opts)
+{
+    size_t accepted = 0;
+
+    int epfd = epoll_create1(0);
+    if (epfd < 0) {
+        fprintf(stderr, "%s epoll_create1: %s\n", ops->tag, strerror(errno));
+        return 0;
+    }
+
+    /* Listener is non-blocking so accept_pending() can stop on EAGAIN */
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events   = EPOLLIN;
+    ev.data.ptr = NULL;             /* NULL marks the listening socket */
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev) < 0) {
+        fprintf(stderr, "%s epoll_ctl listener: %s\n", ops->tag, strerror(errno));
+        close(epfd);
+        return 0;
+    }
+
+    if (stop_fd >= 0) {
+        ev.events   = EPOLLIN;
+        ev.data.ptr = &g_stop_marker;
+        if (epoll_ctl(epfd, EPOLL_CTL_ADD, stop_fd, &ev) < 0) {
+            fprintf(stderr, "%s epoll_ctl eventfd: %s\n",
+                    ops->tag, strerror(errno));
+            close(epfd);
+            return 0;
+        }
+    }
+
+    conn_slot_t *head = NULL;
+    struct epoll_event events[EPOLL_MAX_EVENTS];
+
+    while (g_running) {
+        int n = epoll_wait(epfd, events, EPOLL_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;   /* SIGINT — re-check g_running */
+            }
+            fprintf(stderr, "%s epoll_wait: %s\n", ops->tag, strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            conn_slot_t *slot = (conn_slot_t *)events[i].data.ptr;
+
+            if (slot == NULL) {
+                accept_pending(epfd, listen_fd, &head, &accepted, ops, opts);
+                continue;
+            }
+            if ((void *)slot == &g_stop_marker) {
+                continue;   /* Shutdown requested; g_running is already 0 */
+            }
+
+            if (service_slot(slot, events[i].events) == CONN_CLOSED) {
+                close_slot(epfd, &head, slot);
+            }
+        }
+    }
+
+    /* Shutdown: report and release every connection still open */
+    while (head != NULL) {
+        close_slot(epfd, &head, head);
+    }
+    close(epfd);
+
+    return accepted;
+}
+
+// ===========================================================================
+//  Sharded (SO_REUSEPORT) worker model
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  worker_args_t
+//  -------------
+//  Per-worker context; lives in an array owned by run_sharded().
+// ---------------------------------------------------------------------------
+typedef struct {
+    int                  id;        /* Worker index                          */
+    int                  cpu;       /* CPU to pin to, or -1                  */
+    int                  node;      /* --numa node, or NUMA_OFF              */
+    int                  stop_fd;   /* Shared shutdown eventfd               */
+    const conn_ops_t    *ops;
+    const server_opts_t *opts;
+    size_t               accepted;  /* Connections served (output)          */
+    int                  final_cpu; /* CPU the worker ended on (output)     */
+    bool                 ok;        /* Listener opened successfully (output) */
+} worker_args_t;
+
+// ---------------------------------------------------------------------------
+//  worker_thread
+//  -------------
+//  Pins itself (optionally), opens its own SO_REUSEPORT listener and runs
+//  an independent event loop until the shutdown eventfd fires.
+// ---------------------------------------------------------------------------
+static void *worker_thread(void *arg)
+{
+    worker_args_t *w = (worker_args_t *)arg;
+    const conn_ops_t *ops = w->ops;
+
+    if (w->cpu >= 0 && pin_thread_to_cpu(w->cpu) < 0) {
+        fprintf(stderr, "%s Worker %d: cannot pin to CPU %d: %s\n",
+                ops->tag, w->id, w->cpu, strerror(errno));
+    }
+    if (w->node != NUMA_OFF) {
+        numa_enter(ops, w->node, w->cpu >= 0);
+    }
+    enter_rt(ops, w->opts->rt_prio);
+
+    int listen_fd = open_listener(ops, w->opts, true);
+    if (listen_fd < 0) {
+        return NULL;
+    }
+    w->ok = true;
+
+    /* Prefer this listener for connections whose SYN arrives on our CPU */
+    if (w->cpu >= 0 &&
+        setsockopt(listen_fd, SOL_SOCKET, SO_INCOMING_CPU,
+                   &w->cpu, sizeof(w->cpu)) < 0) {
+        fprintf(stderr, "%s Worker %d: SO_INCOMING_CPU: %s\n",
+                ops->tag, w->id, strerror(errno));
+    }
+
+    if (w->node != NUMA_OFF) {
+        printf("%s Worker %d: listening (cpu=%d, node=%d)\n",
+               ops->tag, w->id, w->cpu, w->node);
+    } else {
+        printf("%s Worker %d: listening (cpu=%d)\n", ops->tag, w->id, w->cpu);
+    }
+
+    w->accepted  = run_event_loop(listen_fd, w->stop_fd, ops, w->opts);
+    w->final_cpu = sched_getcpu();
+
+    close(listen_fd);
+    return NULL;
+}
+
+// ---------------------------------------------------------------------------
+//  run_sharded
+//  -----------
+//  Starts opts->workers event-loop workers and blocks until SIGINT.
+//
+//  Returns:
+//      0 on success, -1 if no worker could be started.
+// ---------------------------------------------------------------------------
+static int run_sharded(const conn_ops_t *ops, const server_opts_t *opts)
+{
+    int stop_fd = eventfd(0, EFD_NONBLOCK);
+    if (stop_fd < 0) {
+        fprintf(stderr, "%s eventfd: %s\n", ops->tag, strerror(errno));
+        return -1;
+    }
+
+    pthread_t     *tids = calloc((size_t)opts->workers, sizeof(pthread_t));
+    worker_args_t *args = calloc((size_t)opts->workers, sizeof(worker_args_t));
+    bool          *live = calloc((size_t)opts->workers, sizeof(bool));
+    if (tids == NULL || args == NULL || live == NULL) {
+        fprintf(stderr, "%s malloc workers: %s\n", ops->tag, strerror(errno));
+        free(tids);
+        free(args);
+        free(live);
+        close(stop_fd);
+        return -1;
+    }
+
+    /*
+     * Block SIGINT before spawning so every worker inherits the mask and
+     * only this thread observes the signal (in sigsuspend below).
+     */
+    sigset_t block, old;
+    sigemptyset(&block);
+    sigaddset(&block, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    for (int i = 0; i < opts->workers; i++) {
+        args[i].id      = i;
+        args[i].cpu     = (opts->n_cpus > 0) ? opts->cpus[i % opts->n_cpus] : -1;
+        /* A pinned worker's node is its CPU's, whatever --numa says */
+        args[i].node    = (opts->numa == NUMA_OFF || args[i].cpu < 0)
+                              ? numa_pick(opts->numa, i)
+                              : numa_cpu_node(args[i].cpu);
+        args[i].stop_fd = stop_fd;
+        args[i].ops     = ops;
+        args[i].opts    = opts;
+
+        if (pthread_create(&tids[i], NULL, worker_thread, &args[i]) != 0) {
+            fprintf(stderr, "%s pthread_create worker %d failed\n", ops->tag, i);
+            continue;
+        }
+        live[i] = true;
+    }
+
+    /* ---- Wait for SIGINT ---------------------------------------------- */
+    sigset_t wait_mask = old;
+    sigdelset(&wait_mask, SIGINT);
+    while (g_running) {
+        sigsuspend(&wait_mask);
+    }
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    /* ---- Wake every worker and collect per-worker totals -------------- */
+    uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) != (ssize_t)sizeof(one)) {
+        fprintf(stderr, "%s eventfd write: %s\n", ops->tag, strerror(errno));
+    }
+
+    int started = 0;
+    for (int i = 0; i < opts->workers; i++) {
+        if (!live[i]) {
+            continue;
+        }
+        pthread_join(tids[i], NULL);
+        if (args[i].ok) {
+            started++;
+            printf("%s Worker %d (cpu=%d, final CPU %d): %zu connections\n",
+                   ops->tag, i, args[i].cpu, args[i].final_cpu,
+                   args[i].accepted);
+        }
+    }
+
+    free(tids);
+    free(args);
+    free(live);
+    close(stop_fd);
+
+    return (started > 0) ? 0 : -1;
+}
+
+// ===========================================================================
+//  server_main
+// ===========================================================================
+int server_main(int argc, char *argv[], const conn_ops_t *ops)
+{
+    server_opts_t opts;
+    if (parse_args(argc, argv, ops, &opts) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%s %s\n", ops->tag, ops->banner);
+    static const char *mode_names[] = { "thread", "epoll", "sharded" };
+    printf("%s Port: %d | Message size: %zu bytes | Mode: %s | "
+           "Fields: %d (%s, %s)\n",
+           ops->tag, opts.port, opts.msg_size, mode_names[opts.mode],
+           opts.layout.n_fields, opts.profile, msg_alloc_name(opts.alloc));
+    if (opts.pool != POOL_MALLOC) {
+        printf("%s Buffer pool: %s%s\n", ops->tag, pool_type_name(opts.pool),
+               opts.mlock ? " (mlocked)" : "");
+    }
+    if (opts.numa == NUMA_RR) {
+        printf("%s NUMA: round-robin over %d node(s)\n",
+               ops->tag, numa_discover());
+    } else if (opts.numa != NUMA_OFF) {
+        printf("%s NUMA: node %d\n", ops->tag, opts.numa);
+    }
+    if (opts.pin != CPU_PIN_NONE || opts.rt_prio > 0) {
+        static const char *const pin_names[] = {
+            "floating", "CPU list", "SO_INCOMING_CPU", "next to SO_INCOMING_CPU"
+        };
+        printf("%s CPU placement: %s", ops->tag, pin_names[opts.pin]);
+        if (opts.pin == CPU_PIN_LIST) {
+            printf(" (%d CPUs)", opts.n_cpus);
+        }
+        if (opts.rt_prio > 0) {
+            printf(", SCHED_FIFO %d", opts.rt_prio);
+        }
+        printf("\n");
+    }
+    pool_configure(opts.pool, opts.mlock);
+
+    /* ---- Install SIGINT handler for graceful shutdown ------------------ */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = sigint_handler;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = 0;            /* No SA_RESTART: let accept/epoll see EINTR */
+    if (sigaction(SIGINT, &sa, NULL) < 0) {
+        fprintf(stderr, "%s sigaction: %s\n", ops->tag, strerror(errno));
+        return EXIT_FAILURE;
+    }
+
+    /* Ignore SIGPIPE so broken-pipe errors are returned via errno */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* ---- Server-specific start-up work -------------------------------- */
+    if (ops->init != NULL && ops->init(&opts) < 0) {
+        return EXIT_FAILURE;
+    }
+
+    /* ---- Sharded model: each worker owns its own listener ------------- */
+    if (opts.mode == SERVER_MODE_SHARDED) {
+        printf("%s Starting %d SO_REUSEPORT workers on port %d … "
+               "(Ctrl+C to stop)\n", ops->tag, opts.workers, opts.port);
+        int rc = run_sharded(ops, &opts);
+        printf("\n%s Shutting down …\n", ops->tag);
+        pool_report(ops->tag);
+        return (rc == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    int listen_fd = open_listener(ops, &opts, false);
+    if (listen_fd < 0) {
+        return EXIT_FAILURE;
+    }
+
+    printf("%s Listening on port %d … (Ctrl+C to stop)\n", ops->tag, opts.port);
+
+    if (opts.mode == SERVER_MODE_EPOLL) {
+        bool pinned = (opts.pin == CPU_PIN_LIST);
+        if (pinned && pin_thread_to_cpu(opts.cpus[0]) < 0) {
+            fprintf(stderr, "%s Cannot pin to CPU %d: %s\n",
+                    ops->tag, opts.cpus[0], strerror(errno));
+        }
+        if (opts.numa != NUMA_OFF) {
+            numa_enter(ops, pinned ? numa_cpu_node(opts.cpus[0]) : opts.numa,
+                       pinned);
+        }
+        enter_rt(ops, opts.rt_prio);
+        run_event_loop(listen_fd, -1, ops, &opts);
+        printf("%s Event loop: final CPU %d\n", ops->tag, sched_getcpu());
+    } else {
+        run_thread_per_client(listen_fd, ops, &opts);
+    }
+
+    printf("\n%s Shutting down …\n", ops->tag);
+    pool_report(ops->tag);
+    close(listen_fd);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,162 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_server.h
+// Purpose: Shared server runtime for PA02.
+//
+//          Every server (A1, A2, A3) implements its send path as a small
+//          per-connection state machine described by a conn_ops_t table.
+//          The runtime owns everything else — argument parsing, SIGINT
+//          handling, the listening socket, and the concurrency model used
+//          to drive the state machines:
+//
+//            thread – one blocking pthread per accepted client (the
+//                     original PA02 model).
+//            epoll  – a single non-blocking, edge-triggered epoll event
+//                     loop multiplexing every connection on one thread.
+//            sharded – N worker threads, each with its own SO_REUSEPORT
+//                     listening socket on the same port and its own epoll
+//                     loop; the kernel spreads new connections across
+//                     the listeners so there is no shared acceptor.
+//
+//          Because every model calls the very same step() function, the
+//          comparison between them isolates the cost of the concurrency
+//          model from the cost of the send primitive.
+// =============================================================================
+
+#ifndef MT25082_SERVER_H
+#define MT25082_SERVER_H
+
+#include "MT25082_common.h"
+
+#include <getopt.h>             /* struct option (per-server extra options)  */
+
+// ===========================================================================
+//  Constants
+// ===========================================================================
+
+#define EPOLL_MAX_EVENTS   64   /* Events harvested per epoll_wait() call.    */
+
+#define MAX_SERVER_OPTS    32   /* Capacity of the merged long-option table.  */
+
+// ===========================================================================
+//  Data Structures
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  server_mode_t
+//  -------------
+//  Concurrency model selected at startup with --mode / --workers.
+// ---------------------------------------------------------------------------
+typedef enum {
+    SERVER_MODE_THREAD = 0,     /* Thread-per-client, blocking sockets       */
+    SERVER_MODE_EPOLL,          /* Edge-triggered epoll, non-blocking sockets*/
+    SERVER_MODE_SHARDED         /* N SO_REUSEPORT listeners, one loop each   */
+} server_mode_t;
+
+// ---------------------------------------------------------------------------
+//  server_opts_t
+//  -------------
+//  Parsed command line, handed to every conn_ops_t::open() call.
+// ---------------------------------------------------------------------------
+typedef struct {
+    int           port;         /* TCP port to listen on                     */
+    size_t        msg_size;     /* Total message payload size (bytes)        */
+    server_mode_t mode;         /* Concurrency model                         */
+    int           workers;      /* Worker count (sharded mode)               */
+    cpu_pin_t     pin;          /* Thread placement (--cpus)                 */
+    int           n_cpus;       /* Entries in cpus[] (CPU_PIN_LIST)          */
+    int           cpus[MAX_CPUS]; /* Thread/worker i on cpus[i % n_cpus]     */
+    int           rt_prio;      /* SCHED_FIFO priority, 0 = off (--rt)       */
+    const char   *profile;      /* --profile as given (for reports)          */
+    msg_layout_t  layout;       /* Field count and sizes of every message    */
+    msg_alloc_t   alloc;        /* Where the fields live (--alloc)           */
+    pool_type_t   pool;         /* Memory behind them (--pool)               */
+    bool          mlock;        /* mlock() the pool arenas (--mlock)         */
+    int           numa;         /* NUMA_OFF, NUMA_RR or a node (--numa)      */
+} server_opts_t;
+
+// ---------------------------------------------------------------------------
+//  conn_status_t
+//  -------------
+//  Result of one state-machine step.
+// ---------------------------------------------------------------------------
+typedef enum {
+    CONN_PROGRESS = 0,          /* Made progress — call step() again         */
+    CONN_BLOCKED,               /* Would block — wait for the next event     */
+    CONN_CLOSED                 /* Peer gone or fatal error — tear down      */
+} conn_status_t;
+
+// ---------------------------------------------------------------------------
+//  conn_ops_t
+//  ----------
+//  Per-server send logic.  Each server file provides one static instance.
+//
+//  Members:
+//      tag      – log prefix, e.g. "[Server-A2]"
+//      banner   – one-line description printed at startup
+//      open     – allocate per-connection state for an accepted socket.
+//                 `nonblocking` is true in the epoll / sharded modes.
+//                 Returns NULL on
+//                 failure (the runtime then closes the fd).
+//      step     – perform one unit of send work (at most one send call).
+//      on_error – optional; invoked when epoll reports EPOLLERR (used by
+//                 A3 to drain MSG_ZEROCOPY completions).  May be NULL.
+//      close    – report statistics, release buffers, close the socket.
+//
+//  Optional server-specific command-line options (all may be NULL):
+//      extra_opts  – NULL-terminated long-option table
+//      extra_short – matching getopt short-option string
+//      extra_usage – usage text describing the extra options
+//      parse_opt   – called for each extra option; returns 0 or -1
+//      init        – called once after argument parsing and before the
+//                    first connection is accepted; returns 0 or -1
+//      thread_only – the send logic cannot run on a non-blocking socket,
+//                    so only --mode thread is accepted
+// ---------------------------------------------------------------------------
+typedef struct {
+    const char    *tag;
+    const char    *banner;
+    void         *(*open)(int fd, const server_opts_t *opts, bool nonblocking);
+    conn_status_t (*step)(void *conn);
+    conn_status_t (*on_error)(void *conn);
+    void          (*close)(void *conn);
+
+    const struct option *extra_opts;
+    const char          *extra_short;
+    const char          *extra_usage;
+    int                (*parse_opt)(int c, const char *arg);
+    int                (*init)(const server_opts_t *opts);
+    bool                 thread_only;
+} conn_ops_t;
+
+// ===========================================================================
+//  Globals
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  g_running
+//  ---------
+//  Cleared by the SIGINT handler; every send / accept / event loop checks
+//  it to exit cleanly.
+// ---------------------------------------------------------------------------
+extern volatile sig_atomic_t g_running;
+
+// ===========================================================================
+//  Function Declarations
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  server_main
+//  -----------
+//  Complete server entry point: parses
+//      <prog> [--mode thread|epoll] [--workers N [--cpus LIST]]
+//             [--nfields N] [--profile P] <port> <message_size_bytes>
+//  installs signal handlers, opens the listening socket and runs the
+//  selected concurrency model until SIGINT.
+//
+//  Returns:
+//      EXIT_SUCCESS or EXIT_FAILURE, suitable for returning from main().
+// ---------------------------------------------------------------------------
+int server_main(int argc, char *argv[], const conn_ops_t *ops);
+
+#endif /* MT25082_SERVER_H */
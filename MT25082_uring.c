@@ -0,0 +1,317 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_uring.c
+// Purpose: Implements the raw-syscall io_uring wrapper declared in
+//          MT25082_uring.h.
+//
+// Memory-ordering notes:
+//   • The kernel reads the SQ tail and writes the CQ tail concurrently with
+//     us, so those loads/stores use acquire/release atomics.  Publishing an
+//     SQE = write the SQE, then store-release the new SQ tail.  Consuming a
+//     CQE = load-acquire the CQ tail, read the CQE, then store-release the
+//     new CQ head so the kernel may reuse the slot.
+//   • On SQPOLL rings the NEED_WAKEUP flag must be read only after the new
+//     SQ tail is globally visible (full fence), otherwise the poller could
+//     go to sleep between our store and our check and miss the SQEs.
+// =============================================================================
+
+#include "MT25082_uring.h"
+
+#include <sys/mman.h>           /* mmap, munmap                              */
+#include <sys/syscall.h>        /* __NR_io_uring_setup / enter / register    */
+
+// ===========================================================================
+//  System-call shims (glibc provides no wrappers)
+// ===========================================================================
+static int sys_io_uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete,
+                              unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                        flags, NULL, 0);
+}
+
+static int sys_io_uring_enter_arg(int fd, unsigned min_complete,
+                                  unsigned flags, const void *arg,
+                                  size_t argsz)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, 0, min_complete,
+                        flags, arg, argsz);
+}
+
+static int sys_io_uring_register(int fd, unsigned opcode, const void *arg,
+                                 unsigned nr_args)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// ===========================================================================
+//  uring_setup
+// ===========================================================================
+//  Follows the io_uring_setup(2) recipe: create the ring, then map the SQ
+//  ring, the CQ ring (shared with the SQ ring on IORING_FEAT_SINGLE_MMAP
+//  kernels) and the SQE array, and cache pointers to the fields we use.
+// ---------------------------------------------------------------------------
+static int uring_setup(uring_t *r, unsigned entries, struct io_uring_params *pp)
+{
+    struct io_uring_params p = *pp;
+    memset(r, 0, sizeof(*r));
+
+    r->ring_fd = sys_io_uring_setup(entries, &p);
+    if (r->ring_fd < 0) {
+        return -1;
+    }
+    r->features = p.features;
+    r->sqpoll   = (p.flags & IORING_SETUP_SQPOLL) != 0;
+
+    r->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_sz = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        if (r->cq_ring_sz > r->sq_ring_sz) {
+            r->sq_ring_sz = r->cq_ring_sz;
+        }
+        r->cq_ring_sz = r->sq_ring_sz;
+    }
+
+    r->sq_ring = mmap(NULL, r->sq_ring_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, r->ring_fd, IORING_OFF_SQ_RING);
+    if (r->sq_ring == MAP_FAILED) {
+        goto fail_fd;
+    }
+
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        r->cq_ring = r->sq_ring;
+    } else {
+        r->cq_ring = mmap(NULL, r->cq_ring_sz, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, r->ring_fd,
+                          IORING_OFF_CQ_RING);
+        if (r->cq_ring == MAP_FAILED) {
+            goto fail_sq;
+        }
+    }
+
+    r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->ring_fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) {
+        goto fail_cq;
+    }
+
+    char *sq = (char *)r->sq_ring;
+    r->sq_head    = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail    = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask    = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_flags   = (unsigned *)(sq + p.sq_off.flags);
+    r->sq_array   = (unsigned *)(sq + p.sq_off.array);
+    r->sq_entries = p.sq_entries;
+    r->sqe_tail   = *r->sq_tail;
+
+    char *cq = (char *)r->cq_ring;
+    r->cq_head    = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail    = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask    = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes       = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    r->cq_entries = p.cq_entries;
+
+    return 0;
+
+fail_cq:
+    if (r->cq_ring != r->sq_ring) {
+        munmap(r->cq_ring, r->cq_ring_sz);
+    }
+fail_sq:
+    munmap(r->sq_ring, r->sq_ring_sz);
+fail_fd:
+    {
+        int saved = errno;
+        close(r->ring_fd);
+        errno = saved;
+    }
+    r->ring_fd = -1;
+    return -1;
+}
+
+// ===========================================================================
+//  uring_init
+// ===========================================================================
+int uring_init(uring_t *r, unsigned entries)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    return uring_setup(r, entries, &p);
+}
+
+// ===========================================================================
+//  uring_init_sqpoll
+// ===========================================================================
+int uring_init_sqpoll(uring_t *r, unsigned entries, int sq_cpu,
+                      unsigned idle_ms, int wq_fd)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+
+    p.flags          = IORING_SETUP_SQPOLL;
+    p.sq_thread_idle = idle_ms;
+    if (sq_cpu >= 0) {
+        p.flags        |= IORING_SETUP_SQ_AFF;
+        p.sq_thread_cpu = (unsigned)sq_cpu;
+    }
+    if (wq_fd >= 0) {
+        p.flags |= IORING_SETUP_ATTACH_WQ;
+        p.wq_fd  = (unsigned)wq_fd;
+    }
+    return uring_setup(r, entries, &p);
+}
+
+// ===========================================================================
+//  uring_exit
+// ===========================================================================
+void uring_exit(uring_t *r)
+{
+    if (r->ring_fd < 0) {
+        return;
+    }
+    munmap(r->sqes, r->sqes_sz);
+    if (r->cq_ring != r->sq_ring) {
+        munmap(r->cq_ring, r->cq_ring_sz);
+    }
+    munmap(r->sq_ring, r->sq_ring_sz);
+    close(r->ring_fd);
+    r->ring_fd = -1;
+}
+
+// ===========================================================================
+//  uring_register_buffers
+// ===========================================================================
+int uring_register_buffers(uring_t *r, const struct iovec *iov, unsigned nr)
+{
+    return sys_io_uring_register(r->ring_fd, IORING_REGISTER_BUFFERS, iov, nr);
+}
+
+// ===========================================================================
+//  uring_register_files
+// ===========================================================================
+int uring_register_files(uring_t *r, const int *fds, unsigned nr)
+{
+    return sys_io_uring_register(r->ring_fd, IORING_REGISTER_FILES, fds, nr);
+}
+
+// ===========================================================================
+//  uring_get_sqe
+// ===========================================================================
+struct io_uring_sqe *uring_get_sqe(uring_t *r)
+{
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+
+    if (r->sqe_tail - head >= r->sq_entries) {
+        return NULL;    /* Submission queue full */
+    }
+
+    unsigned idx = r->sqe_tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+
+    r->sq_array[idx] = idx;     /* Identity mapping: slot i -> SQE i */
+    r->sqe_tail++;
+    return sqe;
+}
+
+// ===========================================================================
+//  uring_submit
+// ===========================================================================
+int uring_submit(uring_t *r, unsigned wait_nr)
+{
+    unsigned old_tail  = *r->sq_tail;
+    unsigned to_submit = r->sqe_tail - old_tail;
+
+    /* Make the prepared SQEs visible before the kernel sees the new tail */
+    __atomic_store_n(r->sq_tail, r->sqe_tail, __ATOMIC_RELEASE);
+
+    /*
+     * If a signal interrupts the wait, the SQEs have already been
+     * consumed; the caller sees -1/EINTR and simply reaps what is there.
+     */
+    unsigned flags = (wait_nr > 0) ? IORING_ENTER_GETEVENTS : 0;
+
+    if (r->sqpoll) {
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        bool wake = (__atomic_load_n(r->sq_flags, __ATOMIC_RELAXED) &
+                     IORING_SQ_NEED_WAKEUP) != 0;
+        if (!wake && wait_nr == 0) {
+            return (int)to_submit;      /* Poller takes it from here */
+        }
+        if (wake) {
+            flags |= IORING_ENTER_SQ_WAKEUP;
+            r->sq_wakeups++;
+        }
+        /* to_submit is ignored for SQPOLL rings; the poller consumes SQEs */
+    }
+
+    r->enter_calls++;
+    return sys_io_uring_enter(r->ring_fd, to_submit, wait_nr, flags);
+}
+
+// ===========================================================================
+//  uring_wait
+// ===========================================================================
+//  IORING_ENTER_EXT_ARG passes a struct io_uring_getevents_arg instead of
+//  a sigmask, which is how io_uring_enter() takes a timeout.  Without the
+//  feature (pre-5.11) there is no bounded wait to offer.
+// ---------------------------------------------------------------------------
+int uring_wait(uring_t *r, unsigned wait_nr, int timeout_ms)
+{
+    if (!(r->features & IORING_FEAT_EXT_ARG)) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    struct __kernel_timespec ts = {
+        .tv_sec  = timeout_ms / 1000,
+        .tv_nsec = (long long)(timeout_ms % 1000) * 1000000,
+    };
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    arg.ts = (unsigned long long)(uintptr_t)&ts;
+
+    r->enter_calls++;
+    return sys_io_uring_enter_arg(r->ring_fd, wait_nr,
+                                  IORING_ENTER_GETEVENTS |
+                                  IORING_ENTER_EXT_ARG,
+                                  &arg, sizeof(arg));
+}
+
+// ===========================================================================
+//  uring_peek_cqe
+// ===========================================================================
+struct io_uring_cqe *uring_peek_cqe(uring_t *r)
+{
+    unsigned head = *r->cq_head;
+    unsigned tail = __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE);
+
+    if (head == tail) {
+        return NULL;
+    }
+    return &r->cqes[head & *r->cq_mask];
+}
+
+// ===========================================================================
+//  uring_cq_overflowed
+// ===========================================================================
+bool uring_cq_overflowed(const uring_t *r)
+{
+    return (__atomic_load_n(r->sq_flags, __ATOMIC_ACQUIRE) &
+            IORING_SQ_CQ_OVERFLOW) != 0;
+}
+
+// ===========================================================================
+//  uring_cqe_seen
+// ===========================================================================
+void uring_cqe_seen(uring_t *r)
+{
+    __atomic_store_n(r->cq_head, *r->cq_head + 1, __ATOMIC_RELEASE);
+}
@@ -0,0 +1,219 @@
+// Roll No: MT25082
+// =============================================================================
+// File:    MT25082_uring.h
+// Purpose: Minimal io_uring wrapper for the PA02 io_uring transports (A4).
+//
+//          Talks to the kernel directly through the io_uring_setup(2) /
+//          io_uring_enter(2) / io_uring_register(2) system calls and the
+//          mmap'd submission / completion rings, so the project keeps
+//          building with nothing more than gcc and the kernel UAPI headers
+//          (no liburing dependency).
+//
+// Ring anatomy (what uring_t caches after setup):
+// ===============================================
+//
+//   User Space                               Kernel
+//  +--------------------+   SQ tail ++      +----------------------+
+//  | SQE array          | ----------------> | consumes SQEs from   |
+//  | (submission queue) |                   | SQ head, executes    |
+//  +--------------------+                   +----------------------+
+//  +--------------------+   CQ tail ++                 |
+//  | CQE array          | <------------------------------+
+//  | (completion queue) |   user advances CQ head after reading
+//  +--------------------+
+//
+//   Submission and completion are decoupled: many SQEs can be queued and
+//   handed to the kernel with ONE io_uring_enter(), and many CQEs can be
+//   harvested without any system call at all.
+//
+//   With IORING_SETUP_SQPOLL a kernel thread polls the SQ tail itself, so
+//   publishing an SQE needs no io_uring_enter() either — only a wake-up
+//   call when that thread has gone idle (IORING_SQ_NEED_WAKEUP).
+// =============================================================================
+
+#ifndef MT25082_URING_H
+#define MT25082_URING_H
+
+#include "MT25082_common.h"
+
+#include <linux/io_uring.h>     /* io_uring_params, io_uring_sqe/cqe, ops    */
+
+// ===========================================================================
+//  Data Structures
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  uring_t
+//  -------
+//  One io_uring instance.  Owned by a single thread; not thread-safe.
+//
+//  Members (selected):
+//      ring_fd     – file descriptor returned by io_uring_setup()
+//      sq_*/cq_*   – pointers into the shared ring mappings
+//      sqe_tail    – local SQ tail (SQEs prepared but not yet published)
+//      sqpoll      – a kernel SQ polling thread consumes submissions
+//      enter_calls – io_uring_enter() system calls issued so far
+//      sq_wakeups  – of those, calls made only to wake the SQ thread
+// ---------------------------------------------------------------------------
+typedef struct {
+    int                  ring_fd;
+    unsigned             features;      /* IORING_FEAT_* from setup          */
+
+    /* Submission queue */
+    unsigned            *sq_head;
+    unsigned            *sq_tail;
+    unsigned            *sq_mask;
+    unsigned            *sq_flags;
+    unsigned            *sq_array;
+    unsigned             sq_entries;
+    unsigned             sqe_tail;      /* Next SQE slot to hand out         */
+    struct io_uring_sqe *sqes;
+
+    /* Completion queue */
+    unsigned            *cq_head;
+    unsigned            *cq_tail;
+    unsigned            *cq_mask;
+    unsigned             cq_entries;
+    struct io_uring_cqe *cqes;
+
+    /* Mappings (for munmap) */
+    void                *sq_ring;
+    size_t               sq_ring_sz;
+    void                *cq_ring;
+    size_t               cq_ring_sz;
+    size_t               sqes_sz;
+
+    bool                 sqpoll;        /* IORING_SETUP_SQPOLL ring          */
+    size_t               enter_calls;   /* io_uring_enter() syscalls issued  */
+    size_t               sq_wakeups;    /* ...issued for SQ thread wake-up   */
+} uring_t;
+
+// ===========================================================================
+//  Function Declarations
+// ===========================================================================
+
+// ---------------------------------------------------------------------------
+//  uring_init
+//  ----------
+//  Creates an io_uring with `entries` SQ slots (the kernel rounds up to a
+//  power of two and sizes the CQ at twice that) and maps its rings.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int uring_init(uring_t *r, unsigned entries);
+
+// ---------------------------------------------------------------------------
+//  uring_init_sqpoll
+//  -----------------
+//  Like uring_init(), but with IORING_SETUP_SQPOLL: a kernel thread polls
+//  the submission queue and goes to sleep after `idle_ms` without work.
+//
+//  Parameters:
+//      sq_cpu  – CPU to pin the polling thread to, or -1 for no pinning
+//      wq_fd   – ring fd whose polling thread to share
+//                (IORING_SETUP_ATTACH_WQ), or -1 to create a new one
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int uring_init_sqpoll(uring_t *r, unsigned entries, int sq_cpu,
+                      unsigned idle_ms, int wq_fd);
+
+// ---------------------------------------------------------------------------
+//  uring_exit
+//  ----------
+//  Unmaps the rings and closes the ring fd.  This does not wait for
+//  anything: the kernel cancels and reaps requests still in flight
+//  asynchronously afterwards, and until then they keep referencing their
+//  buffers.  Collect every outstanding CQE first (uring_wait()) before
+//  freeing memory the requests point at.
+// ---------------------------------------------------------------------------
+void uring_exit(uring_t *r);
+
+// ---------------------------------------------------------------------------
+//  uring_register_buffers
+//  ----------------------
+//  Registers (pins and maps once) the user buffers described by iov[] with
+//  the ring.  SQEs may then refer to buffer i via IORING_RECVSEND_FIXED_BUF
+//  and sqe->buf_index = i, skipping the per-request page pinning.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int uring_register_buffers(uring_t *r, const struct iovec *iov, unsigned nr);
+
+// ---------------------------------------------------------------------------
+//  uring_register_files
+//  --------------------
+//  Registers fds[0..nr-1] with the ring.  SQEs then set IOSQE_FIXED_FILE
+//  and put the table index in sqe->fd, so the kernel skips the per-request
+//  fd lookup and reference counting.
+//
+//  Returns:
+//      0 on success, -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int uring_register_files(uring_t *r, const int *fds, unsigned nr);
+
+// ---------------------------------------------------------------------------
+//  uring_get_sqe
+//  -------------
+//  Returns a zeroed SQE to fill in, or NULL if the submission queue is
+//  full.  The SQE becomes visible to the kernel on the next uring_submit().
+// ---------------------------------------------------------------------------
+struct io_uring_sqe *uring_get_sqe(uring_t *r);
+
+// ---------------------------------------------------------------------------
+//  uring_submit
+//  ------------
+//  Publishes every prepared SQE and enters the kernel once to submit them,
+//  optionally waiting until at least `wait_nr` completions are available.
+//
+//  On an SQPOLL ring the kernel thread picks the SQEs up by itself: the
+//  system call is skipped entirely unless the thread needs a wake-up or
+//  the caller asked to wait.
+//
+//  Returns:
+//      Number of SQEs submitted, or -1 on failure (errno set).
+// ---------------------------------------------------------------------------
+int uring_submit(uring_t *r, unsigned wait_nr);
+
+// ---------------------------------------------------------------------------
+//  uring_wait
+//  ----------
+//  Blocks until at least `wait_nr` completions are available or
+//  `timeout_ms` passes, without submitting anything.  Needs
+//  IORING_FEAT_EXT_ARG (Linux 5.11).
+//
+//  Returns:
+//      ≥ 0 on success, -1 on failure (errno set: ETIME on timeout,
+//      EINTR, or EOPNOTSUPP without the feature).
+// ---------------------------------------------------------------------------
+int uring_wait(uring_t *r, unsigned wait_nr, int timeout_ms);
+
+// ---------------------------------------------------------------------------
+//  uring_peek_cqe
+//  --------------
+//  Returns the oldest unconsumed CQE without any system call, or NULL if
+//  the completion queue is empty.  Call uring_cqe_seen() when done with it.
+// ---------------------------------------------------------------------------
+struct io_uring_cqe *uring_peek_cqe(uring_t *r);
+
+// ---------------------------------------------------------------------------
+//  uring_cq_overflowed
+//  -------------------
+//  True when completions did not fit in the CQ ring and wait on the
+//  kernel's overflow list.  They are moved into the ring only by an
+//  io_uring_enter() with GETEVENTS — which a ring busy-polled without
+//  system calls (SQPOLL) must then issue explicitly.
+// ---------------------------------------------------------------------------
+bool uring_cq_overflowed(const uring_t *r);
+
+// ---------------------------------------------------------------------------
+//  uring_cqe_seen
+//  --------------
+//  Marks the CQE returned by uring_peek_cqe() as consumed.
+// ---------------------------------------------------------------------------
+void uring_cqe_seen(uring_t *r);
+
+#endif /* MT25082_URING_H */